@@ -0,0 +1,193 @@
+#include "animation_track.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace lotate_polyhedron {
+
+namespace {
+
+// A cursor further behind than this is moved by binary search instead.
+constexpr size_t kMaxLinearSeek = 4;
+
+AnimationTrack::Quaternion Slerp(const AnimationTrack::Quaternion& a,
+                                 AnimationTrack::Quaternion b, double u) {
+  double cos_theta = a.w * b.w + a.x * b.x + a.y * b.y + a.z * b.z;
+  // q and -q are the same rotation; take the shorter way round.
+  if (cos_theta < 0.0) {
+    b = {-b.w, -b.x, -b.y, -b.z};
+    cos_theta = -cos_theta;
+  }
+  double wa = 1.0 - u;
+  double wb = u;
+  // Nearly equal keys: the linear blend is exact enough and avoids dividing
+  // by sin(theta) ~ 0.
+  if (cos_theta < 0.9995) {
+    const double theta = std::acos(cos_theta);
+    const double sin_theta = std::sin(theta);
+    wa = std::sin((1.0 - u) * theta) / sin_theta;
+    wb = std::sin(u * theta) / sin_theta;
+  }
+  AnimationTrack::Quaternion q = {wa * a.w + wb * b.w, wa * a.x + wb * b.x,
+                                  wa * a.y + wb * b.y, wa * a.z + wb * b.z};
+  const double length =
+      std::sqrt(q.w * q.w + q.x * q.x + q.y * q.y + q.z * q.z);
+  return {q.w / length, q.x / length, q.y / length, q.z / length};
+}
+
+AnimationTrack::Vector Lerp(const AnimationTrack::Vector& a,
+                            const AnimationTrack::Vector& b, double u) {
+  return {a[0] + (b[0] - a[0]) * u, a[1] + (b[1] - a[1]) * u,
+          a[2] + (b[2] - a[2]) * u};
+}
+
+}  // namespace
+
+AnimationTrack::Quaternion AnimationTrack::Quaternion::FromAxisAngle(
+    const Vector& axis, double angle) {
+  const double length =
+      std::sqrt(axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2]);
+  if (length == 0.0) {
+    return Quaternion();
+  }
+  const double s = std::sin(angle / 2) / length;
+  return {std::cos(angle / 2), axis[0] * s, axis[1] * s, axis[2] * s};
+}
+
+AnimationTrack::Quaternion AnimationTrack::Quaternion::FromEulerAngles(
+    double x, double y, double z) {
+  return FromAxisAngle({0, 0, 1}, z) * FromAxisAngle({0, 1, 0}, y) *
+         FromAxisAngle({1, 0, 0}, x);
+}
+
+AnimationTrack::Quaternion AnimationTrack::Quaternion::operator*(
+    const Quaternion& rhs) const {
+  return {w * rhs.w - x * rhs.x - y * rhs.y - z * rhs.z,
+          w * rhs.x + x * rhs.w + y * rhs.z - z * rhs.y,
+          w * rhs.y - x * rhs.z + y * rhs.w + z * rhs.x,
+          w * rhs.z + x * rhs.y - y * rhs.x + z * rhs.w};
+}
+
+template <typename Value>
+void AnimationTrack::Channel<Value>::Add(double time, const Value& value) {
+  const auto found = std::lower_bound(times.begin(), times.end(), time);
+  const size_t index = found - times.begin();
+  if (found != times.end() && *found == time) {
+    values[index] = value;
+    return;
+  }
+  times.insert(found, time);
+  values.insert(values.begin() + index, value);
+  cursor = 0;
+}
+
+template <typename Value>
+size_t AnimationTrack::Channel<Value>::Seek(double time) {
+  if (time < times[cursor]) {
+    cursor = 0;
+  }
+  for (size_t step = 0; step < kMaxLinearSeek; ++step) {
+    if (cursor + 1 >= times.size() || times[cursor + 1] > time) {
+      return cursor;
+    }
+    ++cursor;
+  }
+  cursor = std::upper_bound(times.begin() + cursor, times.end(), time) -
+           times.begin() - 1;
+  return cursor;
+}
+
+void AnimationTrack::AddRotationKey(double time, const Quaternion& rotation) {
+  rotations_.Add(time, rotation);
+}
+
+void AnimationTrack::AddTranslationKey(double time,
+                                       const Vector& translation) {
+  translations_.Add(time, translation);
+}
+
+void AnimationTrack::AddScaleKey(double time, const Vector& scale) {
+  scales_.Add(time, scale);
+}
+
+double AnimationTrack::GetDuration(void) const {
+  double duration = 0.0;
+  for (const auto* times :
+       {&rotations_.times, &translations_.times, &scales_.times}) {
+    if (!times->empty()) {
+      duration = std::max(duration, times->back());
+    }
+  }
+  return duration;
+}
+
+template <typename Value, typename Interpolate>
+Value AnimationTrack::Sample(Channel<Value>& channel, double time,
+                             const Value& identity,
+                             Interpolate interpolate) const {
+  const auto& times = channel.times;
+  const auto& values = channel.values;
+  if (times.empty()) {
+    return identity;
+  }
+  time = WrapTime(time);
+  if (time <= times.front()) {
+    return values.front();
+  }
+  if (time >= times.back()) {
+    return values.back();
+  }
+  const size_t i = channel.Seek(time);
+  return interpolate(values[i], values[i + 1],
+                     (time - times[i]) / (times[i + 1] - times[i]));
+}
+
+AnimationTrack::Quaternion AnimationTrack::EvaluateRotation(double time) {
+  return Sample(rotations_, time, Quaternion(), Slerp);
+}
+
+AnimationTrack::Vector AnimationTrack::EvaluateTranslation(double time) {
+  return Sample(translations_, time, Vector{0.0, 0.0, 0.0}, Lerp);
+}
+
+AnimationTrack::Vector AnimationTrack::EvaluateScale(double time) {
+  return Sample(scales_, time, Vector{1.0, 1.0, 1.0}, Lerp);
+}
+
+AnimationTrack::Transform AnimationTrack::Evaluate(double time) {
+  return MakeTransform(EvaluateRotation(time), EvaluateTranslation(time),
+                       EvaluateScale(time));
+}
+
+AnimationTrack::Transform AnimationTrack::MakeTransform(
+    const Quaternion& q, const Vector& translation, const Vector& scale) {
+  const double rotation[3][3] = {
+      {1 - 2 * (q.y * q.y + q.z * q.z), 2 * (q.x * q.y - q.w * q.z),
+       2 * (q.x * q.z + q.w * q.y)},
+      {2 * (q.x * q.y + q.w * q.z), 1 - 2 * (q.x * q.x + q.z * q.z),
+       2 * (q.y * q.z - q.w * q.x)},
+      {2 * (q.x * q.z - q.w * q.y), 2 * (q.y * q.z + q.w * q.x),
+       1 - 2 * (q.x * q.x + q.y * q.y)},
+  };
+  Transform transform;
+  for (int row = 0; row < 3; ++row) {
+    for (int column = 0; column < 3; ++column) {
+      transform.matrix[row][column] =
+          FloatType(rotation[row][column] * scale[column]);
+    }
+  }
+  transform.translation =
+      DotType(translation[0], translation[1], translation[2]);
+  return transform;
+}
+
+double AnimationTrack::WrapTime(double time) const {
+  const double duration = GetDuration();
+  if (!looping_ || duration <= 0.0) {
+    return time;
+  }
+  time = std::fmod(time, duration);
+  return time < 0.0 ? time + duration : time;
+}
+
+}  // namespace lotate_polyhedron
@@ -0,0 +1,123 @@
+#ifndef LOTATE_POLYHEDRON_ANIMATION_TRACK_H_
+#define LOTATE_POLYHEDRON_ANIMATION_TRACK_H_
+
+#include <array>
+#include <cstddef>
+#include <vector>
+
+#include "dot.hpp"
+#include "fixed_point.hpp"
+
+namespace lotate_polyhedron {
+
+// Keyframed rotation, translation and scale of one shape over time.
+//
+// Each channel keeps its key times and values in two sorted arrays plus a
+// cursor at the last key it was evaluated at. Time usually moves forward a
+// little every frame, so a lookup only checks the next key or two; a jump
+// backwards or far ahead falls back to a binary search. Rotation is
+// spherically interpolated, translation and scale linearly, and times
+// outside the keys clamp to the first or last key.
+class AnimationTrack {
+ public:
+  using FloatType = FixedPoint<32>;
+  using DotType = Dot<FloatType>;
+  using Vector = std::array<double, 3>;
+
+  // Unit quaternion w + xi + yj + zk.
+  struct Quaternion {
+    double w = 1.0;
+    double x = 0.0;
+    double y = 0.0;
+    double z = 0.0;
+
+    // Right-handed rotation by angle radians around (x, y, z).
+    static Quaternion FromAxisAngle(const Vector& axis, double angle);
+
+    // Rotation around X, then Y, then Z, the order the scene applies
+    // LotateEveryShapeAround?Axis in.
+    static Quaternion FromEulerAngles(double x, double y, double z);
+
+    Quaternion operator*(const Quaternion& rhs) const;
+  };
+
+  // p' = matrix * p + translation, with the scale folded into the matrix.
+  struct Transform {
+    FloatType matrix[3][3];
+    DotType translation;
+
+    inline DotType Apply(const DotType& p) const {
+      return DotType(
+          matrix[0][0] * p.x + matrix[0][1] * p.y + matrix[0][2] * p.z +
+              translation.x,
+          matrix[1][0] * p.x + matrix[1][1] * p.y + matrix[1][2] * p.z +
+              translation.y,
+          matrix[2][0] * p.x + matrix[2][1] * p.y + matrix[2][2] * p.z +
+              translation.z);
+    }
+  };
+
+ public:
+  explicit AnimationTrack(void) : looping_(false) {}
+
+ public:
+  // A key at the time of an existing key replaces it.
+  void AddRotationKey(double time, const Quaternion& rotation);
+  void AddTranslationKey(double time, const Vector& translation);
+  void AddScaleKey(double time, const Vector& scale);
+
+  // Repeats the track every GetDuration() seconds instead of holding the
+  // last key.
+  inline void SetLooping(bool enable) { looping_ = enable; }
+  inline bool IsLooping(void) const { return looping_; }
+
+  inline bool IsEmpty(void) const {
+    return rotations_.times.empty() && translations_.times.empty() &&
+           scales_.times.empty();
+  }
+
+  // Time of the last key over all channels.
+  double GetDuration(void) const;
+
+  Quaternion EvaluateRotation(double time);
+  Vector EvaluateTranslation(double time);
+  Vector EvaluateScale(double time);
+
+  Transform Evaluate(double time);
+
+  static Transform MakeTransform(const Quaternion& rotation,
+                                 const Vector& translation,
+                                 const Vector& scale);
+
+ private:
+  template <typename Value>
+  struct Channel {
+    std::vector<double> times;
+    std::vector<Value> values;
+    size_t cursor = 0;
+
+    void Add(double time, const Value& value);
+
+    // Index of the last key at or before time; time must lie within the
+    // keys.
+    size_t Seek(double time);
+  };
+
+ private:
+  double WrapTime(double time) const;
+
+  // Value of channel at time, identity if it has no keys.
+  template <typename Value, typename Interpolate>
+  Value Sample(Channel<Value>& channel, double time, const Value& identity,
+               Interpolate interpolate) const;
+
+ private:
+  Channel<Quaternion> rotations_;
+  Channel<Vector> translations_;
+  Channel<Vector> scales_;
+  bool looping_;
+};
+
+}  // namespace lotate_polyhedron
+
+#endif
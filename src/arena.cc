@@ -0,0 +1,69 @@
+#include "arena.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+
+#include "stats.h"
+
+namespace lotate_polyhedron {
+
+Arena::Arena(size_t block_size)
+    : block_size_(block_size),
+      current_block_(0),
+      offset_(0),
+      used_bytes_(0),
+      block_allocation_count_(0) {}
+
+void* Arena::Allocate(size_t size, size_t alignment) {
+  while (true) {
+    if (current_block_ < blocks_.size()) {
+      const Block& block = blocks_[current_block_];
+      const uintptr_t base = reinterpret_cast<uintptr_t>(block.data.get());
+      const uintptr_t aligned =
+          (base + offset_ + alignment - 1) & ~(uintptr_t(alignment) - 1);
+      const size_t end = aligned - base + size;
+      if (end <= block.size) {
+        used_bytes_ += end - offset_;
+        offset_ = end;
+        return reinterpret_cast<void*>(aligned);
+      }
+      if (current_block_ + 1 < blocks_.size()) {
+        ++current_block_;
+        offset_ = 0;
+        continue;
+      }
+    }
+    AddBlock(size + alignment);
+  }
+}
+
+void Arena::Reset(void) {
+  if (blocks_.size() > 1) {
+    const size_t capacity = GetCapacity();
+    blocks_.clear();
+    AddBlock(capacity);
+  }
+  current_block_ = 0;
+  offset_ = 0;
+  used_bytes_ = 0;
+}
+
+size_t Arena::GetCapacity(void) const {
+  size_t capacity = 0;
+  for (const auto& block : blocks_) {
+    capacity += block.size;
+  }
+  return capacity;
+}
+
+void Arena::AddBlock(size_t min_size) {
+  const size_t size = std::max(block_size_, min_size);
+  blocks_.push_back(Block{std::unique_ptr<char[]>(new char[size]), size});
+  current_block_ = blocks_.size() - 1;
+  offset_ = 0;
+  ++block_allocation_count_;
+  LOTATE_POLYHEDRON_STATS_COUNT(kArenaBlocksAllocated, 1);
+}
+
+}  // namespace lotate_polyhedron
@@ -0,0 +1,103 @@
+#ifndef LOTATE_POLYHEDRON_ARENA_H_
+#define LOTATE_POLYHEDRON_ARENA_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace lotate_polyhedron {
+
+// Bump allocator for short-lived data such as per-frame temporaries or
+// scratch space while building meshes.
+//
+// Allocate() only moves an offset forward; nothing is freed individually.
+// Reset() makes all memory reusable. If the last cycle spilled into more
+// than one block, Reset() replaces them with a single block large enough
+// for all of it, so a steady workload stops allocating after warm-up.
+class Arena {
+ public:
+  constexpr static size_t kDefaultBlockSize = 64 * 1024;
+
+ public:
+  explicit Arena(size_t block_size = kDefaultBlockSize);
+
+  Arena(const Arena&) = delete;
+  Arena& operator=(const Arena&) = delete;
+
+ public:
+  void* Allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+
+  template <typename T>
+  inline T* AllocateArray(size_t n) {
+    return static_cast<T*>(Allocate(sizeof(T) * n, alignof(T)));
+  }
+
+  void Reset(void);
+
+  inline size_t GetUsedBytes(void) const { return used_bytes_; }
+
+  size_t GetCapacity(void) const;
+
+  // Number of heap blocks allocated over the arena's lifetime.
+  inline uint64_t GetBlockAllocationCount(void) const {
+    return block_allocation_count_;
+  }
+
+ private:
+  struct Block {
+    std::unique_ptr<char[]> data;
+    size_t size;
+  };
+
+  void AddBlock(size_t min_size);
+
+ private:
+  size_t block_size_;
+  std::vector<Block> blocks_;
+  size_t current_block_;
+  size_t offset_;
+  size_t used_bytes_;
+  uint64_t block_allocation_count_;
+};
+
+// Standard allocator adapter so containers can live in an Arena.
+// Deallocation is a no-op; memory comes back on Arena::Reset().
+template <typename T>
+class ArenaAllocator {
+ public:
+  using value_type = T;
+
+  template <typename U>
+  friend class ArenaAllocator;
+
+ public:
+  explicit ArenaAllocator(Arena& arena) : arena_(&arena) {}
+
+  template <typename U>
+  ArenaAllocator(const ArenaAllocator<U>& other) : arena_(other.arena_) {}
+
+  inline T* allocate(size_t n) { return arena_->AllocateArray<T>(n); }
+
+  inline void deallocate(T* p, size_t n) {}
+
+  template <typename U>
+  inline bool operator==(const ArenaAllocator<U>& rhs) const {
+    return arena_ == rhs.arena_;
+  }
+
+  template <typename U>
+  inline bool operator!=(const ArenaAllocator<U>& rhs) const {
+    return arena_ != rhs.arena_;
+  }
+
+ private:
+  Arena* arena_;
+};
+
+template <typename T>
+using ArenaVector = std::vector<T, ArenaAllocator<T>>;
+
+}  // namespace lotate_polyhedron
+
+#endif
@@ -0,0 +1,134 @@
+#include "batch_renderer.h"
+
+#include <algorithm>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+#include "animation_track.h"
+
+namespace lotate_polyhedron {
+
+void BatchRenderer::Render(OutputBackend& output) {
+  size_t jobs = options_.jobs;
+  if (jobs == 0) {
+    jobs = std::max<size_t>(1, std::thread::hardware_concurrency());
+  }
+  jobs = std::max<size_t>(1, std::min(jobs, options_.frame_count));
+  window_ = kWindowPerJob * jobs;
+  slots_.assign(window_, std::string());
+  ready_.assign(window_, 0);
+  next_frame_ = 0;
+  next_write_ = 0;
+
+  std::vector<std::thread> workers;
+  workers.reserve(jobs);
+  for (size_t i = 0; i < jobs; ++i) {
+    workers.emplace_back(&BatchRenderer::Work, this);
+  }
+
+  constexpr char kClear[] = "\x1b[H\x1b[2J";
+  constexpr char kHome[] = "\x1b[H";
+  constexpr char kFormFeed[] = "\f\n";
+  std::string frame;
+  for (size_t i = 0; i < options_.frame_count; ++i) {
+    const size_t slot = i % window_;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      changed_.wait(lock, [this, slot] { return ready_[slot] != 0; });
+      frame.swap(slots_[slot]);
+    }
+    if (options_.format == Format::kAnsi) {
+      if (i == 0) {
+        output.Write(kClear, sizeof(kClear) - 1);
+      } else {
+        output.Write(kHome, sizeof(kHome) - 1);
+      }
+    } else if (i > 0) {
+      output.Write(kFormFeed, sizeof(kFormFeed) - 1);
+    }
+    output.Write(frame.data(), frame.size());
+    output.EndFrame();
+
+    // Hand the storage back so the slot's next frame reuses it.
+    frame.clear();
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      frame.swap(slots_[slot]);
+      ready_[slot] = 0;
+      ++next_write_;
+    }
+    changed_.notify_all();
+  }
+
+  for (auto& worker : workers) {
+    worker.join();
+  }
+}
+
+void BatchRenderer::Work(void) {
+  ConsoleCoordinate cc(scene_);
+  if (options_.format == Format::kAnsi) {
+    cc.SetShadingMode(ConsoleBuffer::ShadingMode::kAnsi256);
+  }
+  // Shapes without a track of their own get one holding just the frame's
+  // rotation, so turning them never touches their vertices.
+  std::vector<size_t> turned;
+  for (size_t s = 0; s < cc.GetShapeCount(); ++s) {
+    if (cc.GetAnimationTrack(s) == nullptr) {
+      AnimationTrack track;
+      track.AddRotationKey(0.0, AnimationTrack::Quaternion());
+      cc.SetAnimationTrack(s, track);
+      turned.push_back(s);
+    }
+  }
+
+  StringOutput encoded;
+  while (true) {
+    size_t index;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      changed_.wait(lock, [this] {
+        return next_frame_ >= options_.frame_count ||
+               next_frame_ < next_write_ + window_;
+      });
+      if (next_frame_ >= options_.frame_count) {
+        return;
+      }
+      index = next_frame_++;
+    }
+
+    const auto& step = options_.rotation_step;
+    const AnimationTrack::Quaternion rotation =
+        AnimationTrack::Quaternion::FromEulerAngles(
+            index * step[0], index * step[1], index * step[2]);
+    for (const size_t s : turned) {
+      cc.GetAnimationTrack(s)->AddRotationKey(0.0, rotation);
+    }
+    // Static shapes have no tracks but are cheap to copy; restore them
+    // from the scene and turn them by the same rotation, converted once.
+    const AnimationTrack::Transform transform = AnimationTrack::MakeTransform(
+        rotation, {0.0, 0.0, 0.0}, {1.0, 1.0, 1.0});
+    cc.CopyStaticShapesFrom(scene_);
+    cc.ForEachStaticShape([&transform](auto& shape) {
+      using StaticShapeType = std::decay_t<decltype(shape)>;
+      shape = StaticShapeType(
+          shape.Map([&transform](const auto& v) { return transform.Apply(v); }),
+          shape.GetLineElements());
+    });
+    cc.SetAnimationTime(index * options_.time_step);
+    cc.Clear();
+    cc.Rasterize();
+    encoded.GetString().clear();
+    cc.DrawTo(encoded);
+
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      slots_[index % window_].swap(encoded.GetString());
+      ready_[index % window_] = 1;
+    }
+    changed_.notify_all();
+  }
+}
+
+}  // namespace lotate_polyhedron
@@ -0,0 +1,89 @@
+#ifndef LOTATE_POLYHEDRON_BATCH_RENDERER_H_
+#define LOTATE_POLYHEDRON_BATCH_RENDERER_H_
+
+#include <array>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "console_coordinate.h"
+#include "output_backend.h"
+
+namespace lotate_polyhedron {
+
+// Renders a fixed sequence of frames of one scene without a terminal and
+// writes them, in order, to an output backend.
+//
+// A frame's pose only depends on its index, so worker threads each render
+// frames into their own headless copy of the scene. Encoded frames wait in
+// a window of kWindowPerJob slots per worker until every earlier frame is
+// written. A worker that gets that far ahead blocks, so memory stays
+// bounded however many frames are rendered.
+class BatchRenderer {
+ public:
+  enum class Format {
+    // Characters as drawn; every frame after the first starts with a
+    // form feed line.
+    kText,
+    // 256-color shading, every frame starting with cursor home, so printing
+    // the file plays the sequence back.
+    kAnsi,
+  };
+
+  struct Options {
+    size_t frame_count = 360;
+    // Frame i turns every static shape and every shape without an
+    // animation track by i * rotation_step radians around X, then Y, then Z.
+    std::array<double, 3> rotation_step = {0.0, 0.0174532925199, 0.0};
+    // Frame i is at animation time i * time_step, for animated shapes.
+    double time_step = 1.0 / 30;
+    Format format = Format::kText;
+    // Worker threads; 0 uses every core.
+    size_t jobs = 0;
+  };
+
+  constexpr static size_t kWindowPerJob = 4;
+
+ public:
+  explicit BatchRenderer(void) = delete;
+
+  // scene must be headless and outlive the renderer.
+  explicit BatchRenderer(const ConsoleCoordinate& scene,
+                         const Options& options)
+      : scene_(scene),
+        options_(options),
+        window_(0),
+        next_frame_(0),
+        next_write_(0) {}
+
+  BatchRenderer(const BatchRenderer&) = delete;
+  BatchRenderer& operator=(const BatchRenderer&) = delete;
+
+ public:
+  // Blocks until every frame has been written to output.
+  void Render(OutputBackend& output);
+
+ private:
+  void Work(void);
+
+ private:
+  const ConsoleCoordinate& scene_;
+  Options options_;
+  size_t window_;
+
+  std::mutex mutex_;
+  std::condition_variable changed_;
+  // Next frame to be claimed by a worker, and next to be written.
+  size_t next_frame_;
+  size_t next_write_;
+  // Frame i is encoded into slot i % window_.
+  std::vector<std::string> slots_;
+  std::vector<uint8_t> ready_;
+};
+
+}  // namespace lotate_polyhedron
+
+#endif
@@ -1,28 +1,205 @@
 #include "console_buffer.h"
 
-#include <iostream>
+#include <algorithm>
+#include <cstring>
+#include <string>
 #include <vector>
 
+#include "stats.h"
+
 namespace lotate_polyhedron {
 
-void ConsoleBuffer::Draw(void) const {
-  for (size_t y = 0; y < console_height_ - 1; ++y) {
-    for (size_t x = 0; x < console_width_; ++x) {
-      std::wcout << screen_buffer_[current_buffer_][y][x];
+namespace {
+
+constexpr wchar_t kGlyphRamp[] = L" .:-=+*#%@";
+constexpr size_t kGlyphRampSize = sizeof(kGlyphRamp) / sizeof(wchar_t) - 1;
+
+inline wchar_t IntensityToGlyph(uint8_t intensity) {
+  if (intensity == 0) {
+    return kGlyphRamp[0];
+  }
+  // Any non-zero coverage must stay visible, so skip the blank glyph.
+  return kGlyphRamp[1 + (intensity - 1) * (kGlyphRampSize - 1) / 255];
+}
+
+inline void AppendUtf8(std::string& out, wchar_t c) {
+  const uint32_t code = static_cast<uint32_t>(c);
+  if (code < 0x80) {
+    out.push_back(static_cast<char>(code));
+  } else if (code < 0x800) {
+    out.push_back(static_cast<char>(0xC0 | (code >> 6)));
+    out.push_back(static_cast<char>(0x80 | (code & 0x3F)));
+  } else if (code < 0x10000) {
+    out.push_back(static_cast<char>(0xE0 | (code >> 12)));
+    out.push_back(static_cast<char>(0x80 | ((code >> 6) & 0x3F)));
+    out.push_back(static_cast<char>(0x80 | (code & 0x3F)));
+  } else {
+    out.push_back(static_cast<char>(0xF0 | (code >> 18)));
+    out.push_back(static_cast<char>(0x80 | ((code >> 12) & 0x3F)));
+    out.push_back(static_cast<char>(0x80 | ((code >> 6) & 0x3F)));
+    out.push_back(static_cast<char>(0x80 | (code & 0x3F)));
+  }
+}
+
+// Maps intensity onto the 24-step grayscale ramp (232-255) of 256-color ANSI.
+inline int IntensityToAnsiGray(uint8_t intensity) {
+  return 232 + intensity * 23 / 255;
+}
+
+}  // namespace
+
+OutputBackend* ConsoleBuffer::output_backend_ = nullptr;
+
+OutputBackend& ConsoleBuffer::GetOutputBackend(void) {
+  if (output_backend_ == nullptr) {
+    static FileOutput standard_output(stdout);
+    return standard_output;
+  }
+  return *output_backend_;
+}
+
+int ConsoleBuffer::ClearScreen(void) {
+  // Same bytes `clear` prints: home, erase screen, erase scrollback.
+  constexpr char kClear[] = "\x1b[H\x1b[2J\x1b[3J";
+  GetOutputBackend().Write(kClear, sizeof(kClear) - 1);
+  return 0;
+}
+
+void ConsoleBuffer::DrawBuffer(
+    const std::vector<std::vector<wchar_t>>& screen,
+    const std::vector<uint8_t>& intensity,
+    const std::vector<RowExtent>& extents, size_t width, size_t height,
+    ShadingMode shading_mode, OutputBackend& output) {
+  LOTATE_POLYHEDRON_STATS_TIMER(kFlushTime);
+  if (height == 0) {
+    return;
+  }
+  if (shading_mode != ShadingMode::kNone) {
+    DrawShadedBuffer(screen, intensity, width, height, shading_mode, output);
+    return;
+  }
+  // Rows are encoded to UTF-8 once here instead of per character by the
+  // stream locale; the buffer is reused across frames.
+  // Columns outside a row's dirty extent are blank and written without
+  // being read.
+  const bool known_extents = extents.size() == height;
+  thread_local std::string row;
+  uint64_t bytes = 0;
+  for (size_t y = 0; y < height; ++y) {
+    RowExtent extent =
+        known_extents ? extents[y] : RowExtent{0, screen[y].size()};
+    extent.end = std::min(extent.end, width);
+    row.clear();
+    if (extent.IsEmpty()) {
+      row.append(width, ' ');
+    } else {
+      row.append(extent.begin, ' ');
+      for (size_t x = extent.begin; x < extent.end; ++x) {
+        AppendUtf8(row, screen[y][x]);
+      }
+      row.append(width - extent.end, ' ');
     }
-    std::wcout << L'\n';
+    row.push_back('\n');
+    output.Write(row.data(), row.size());
+    bytes += row.size();
   }
-  for (size_t x = 0; x < console_width_; ++x) {
-    std::wcout << screen_buffer_[current_buffer_][console_height_ - 1][x];
+  output.EndFrame();
+  LOTATE_POLYHEDRON_STATS_COUNT(kBytesFlushed, bytes);
+}
+
+void ConsoleBuffer::DrawShadedBuffer(
+    const std::vector<std::vector<wchar_t>>& screen,
+    const std::vector<uint8_t>& intensity, size_t width, size_t height,
+    ShadingMode shading_mode, OutputBackend& output) {
+  thread_local std::string row;
+  uint64_t bytes = 0;
+  int last_color = -1;
+  for (size_t y = 0; y < height; ++y) {
+    row.clear();
+    for (size_t x = 0; x < width; ++x) {
+      const wchar_t c = screen[y][x];
+      const uint8_t i = intensity[y * width + x];
+      // Characters written by SetAt/PrintAt take priority over coverage.
+      if (c != L' ' || i == 0) {
+        if (shading_mode == ShadingMode::kAnsi256 && last_color != -1) {
+          row += "\x1b[0m";
+          last_color = -1;
+        }
+        AppendUtf8(row, c);
+        continue;
+      }
+      if (shading_mode == ShadingMode::kAnsi256) {
+        const int color = IntensityToAnsiGray(i);
+        if (color != last_color) {
+          row += "\x1b[38;5;";
+          row += std::to_string(color);
+          row.push_back('m');
+          last_color = color;
+        }
+      }
+      row.push_back(static_cast<char>(IntensityToGlyph(i)));
+    }
+    if (y + 1 == height && last_color != -1) {
+      row += "\x1b[0m";
+    }
+    row.push_back('\n');
+    output.Write(row.data(), row.size());
+    bytes += row.size();
   }
-  std::wcout << std::endl;
+  output.EndFrame();
+  LOTATE_POLYHEDRON_STATS_COUNT(kBytesFlushed, bytes);
 }
 
 void ConsoleBuffer::Clear(void) {
+  auto& screen = screen_buffer_[current_buffer_];
   for (size_t y = 0; y < console_height_; ++y) {
-    for (size_t x = 0; x < console_width_; ++x) {
-      screen_buffer_[current_buffer_][y][x] = ' ';
+    RowExtent& extent = dirty_extents_[current_buffer_][y];
+    if (!extent.IsEmpty()) {
+      std::fill(screen[y].begin() + extent.begin,
+                screen[y].begin() + extent.end, L' ');
     }
+    extent = RowExtent{console_width_, 0};
+  }
+  if (shading_mode_ != ShadingMode::kNone) {
+    std::memset(intensity_buffer_[current_buffer_].data(), 0,
+                intensity_buffer_[current_buffer_].size());
+  }
+}
+
+wchar_t ConsoleBuffer::GetDisplayedAt(size_t x, size_t y) const {
+  const wchar_t c = screen_buffer_[current_buffer_][y][x];
+  if (shading_mode_ == ShadingMode::kNone || c != L' ') {
+    return c;
+  }
+  return IntensityToGlyph(GetIntensityAt(x, y));
+}
+
+void ConsoleBuffer::ExchangeBuffer(Frame& frame) {
+  std::swap(screen_buffer_[current_buffer_], frame.screen);
+  std::swap(intensity_buffer_[current_buffer_], frame.intensity);
+  // The extents that come in still describe the storage they came with.
+  std::swap(dirty_extents_[current_buffer_], frame.extents);
+  // Storage from a shaded frame still holds its coverage.
+  const bool stale_intensity = frame.shading_mode != ShadingMode::kNone;
+  frame.width = console_width_;
+  frame.height = console_height_;
+  frame.shading_mode = shading_mode_;
+
+  auto& screen = screen_buffer_[current_buffer_];
+  auto& extents = dirty_extents_[current_buffer_];
+  if (screen.size() != console_height_ ||
+      (console_height_ > 0 && screen[0].size() != console_width_)) {
+    screen.assign(console_height_, std::vector<wchar_t>(console_width_, ' '));
+    extents.assign(console_height_, RowExtent{console_width_, 0});
+  } else if (extents.size() != console_height_) {
+    // Nothing is known about the storage that came in.
+    extents.assign(console_height_, RowExtent{0, console_width_});
+  }
+  auto& intensity = intensity_buffer_[current_buffer_];
+  if (stale_intensity) {
+    intensity.assign(console_width_ * console_height_, 0);
+  } else {
+    intensity.resize(console_width_ * console_height_);
   }
 }
 
@@ -4,14 +4,45 @@
 #include <sys/ioctl.h>
 #include <unistd.h>
 
+#include <algorithm>
+#include <cstdint>
 #include <cstdlib>
+#include <cstring>
 #include <iostream>
 #include <string>
 #include <vector>
 
+#include "output_backend.h"
+
 namespace lotate_polyhedron {
 
 class ConsoleBuffer {
+ public:
+  // How the per-cell intensity buffer is turned into output at flush time.
+  // kNone ignores intensity and prints the character buffer as is.
+  enum class ShadingMode { kNone, kGlyphRamp, kAnsi256 };
+
+  // Columns [begin, end) of a row written since the last Clear().
+  struct RowExtent {
+    size_t begin;
+    size_t end;
+
+    inline bool IsEmpty(void) const { return begin >= end; }
+  };
+
+  // A rendered frame detached from the buffer, so it can be handed to another
+  // thread with ExchangeBuffer() and presented later with DrawFrame().
+  struct Frame {
+    std::vector<std::vector<wchar_t>> screen;
+    std::vector<uint8_t> intensity;
+    // Dirty columns of each row, as in the buffer it came from; empty if
+    // unknown, in which case every cell is read.
+    std::vector<RowExtent> extents;
+    size_t width = 0;
+    size_t height = 0;
+    ShadingMode shading_mode = ShadingMode::kNone;
+  };
+
  public:
   inline static int GetConsoleSize(size_t& width, size_t& height) {
     winsize size;
@@ -27,29 +58,66 @@ class ConsoleBuffer {
     std::cout.tie(nullptr);
   }
 
-  inline static int ClearScreen(void) { return system("clear"); }
+  // Starts the next frame on the output backend with a screen clear.
+  static int ClearScreen(void);
+
+  // Frames are written to backend, which must outlive its use; nullptr
+  // restores the default blocking writer on stdout.
+  inline static void SetOutputBackend(OutputBackend* backend) {
+    output_backend_ = backend;
+  }
+
+  static OutputBackend& GetOutputBackend(void);
+
+  inline static void DrawFrame(const Frame& frame) {
+    DrawBuffer(frame.screen, frame.intensity, frame.extents, frame.width,
+               frame.height, frame.shading_mode, GetOutputBackend());
+  }
 
   explicit ConsoleBuffer(void)
-      : current_buffer_(0), console_width_(0), console_height_(0) {
+      : current_buffer_(0),
+        console_width_(0),
+        console_height_(0),
+        shading_mode_(ShadingMode::kNone),
+        headless_(false) {
     SyncConsoleSize();
     InitializeScreenBuffer();
   }
 
+  // Headless buffer with a fixed size that never follows the terminal, for
+  // offline rendering and golden-frame checks.
+  explicit ConsoleBuffer(size_t width, size_t height)
+      : current_buffer_(0),
+        console_width_(width),
+        console_height_(height),
+        shading_mode_(ShadingMode::kNone),
+        headless_(true) {
+    InitializeScreenBuffer();
+  }
+
   ConsoleBuffer(const ConsoleBuffer& cb)
       : current_buffer_(cb.current_buffer_),
         console_width_(cb.console_width_),
-        console_height_(cb.console_height_) {
+        console_height_(cb.console_height_),
+        shading_mode_(cb.shading_mode_),
+        headless_(cb.headless_) {
     for (int i = 0; i < 2; ++i) {
       screen_buffer_[i] = cb.screen_buffer_[i];
+      intensity_buffer_[i] = cb.intensity_buffer_[i];
+      dirty_extents_[i] = cb.dirty_extents_[i];
     }
   }
 
   ConsoleBuffer(ConsoleBuffer&& cb)
       : current_buffer_(cb.current_buffer_),
         console_width_(cb.console_width_),
-        console_height_(cb.console_height_) {
+        console_height_(cb.console_height_),
+        shading_mode_(cb.shading_mode_),
+        headless_(cb.headless_) {
     for (int i = 0; i < 2; ++i) {
       screen_buffer_[i] = std::move(cb.screen_buffer_[i]);
+      intensity_buffer_[i] = std::move(cb.intensity_buffer_[i]);
+      dirty_extents_[i] = std::move(cb.dirty_extents_[i]);
     }
   }
 
@@ -61,9 +129,18 @@ class ConsoleBuffer {
       for (size_t j = 0; j < console_height_; ++j) {
         screen_buffer_[i].push_back(std::vector<wchar_t>(console_width_, ' '));
       }
+      // Intensity lives in one flat block per frame so Clear() is one memset.
+      intensity_buffer_[i].assign(console_width_ * console_height_, 0);
+      dirty_extents_[i].assign(console_height_, RowExtent{console_width_, 0});
     }
   }
 
+  inline void MarkDirty(size_t y, size_t begin, size_t end) {
+    RowExtent& extent = dirty_extents_[current_buffer_][y];
+    extent.begin = std::min(extent.begin, begin);
+    extent.end = std::max(extent.end, end);
+  }
+
  public:
   inline size_t GetConsoleWidth(void) const { return console_width_; }
 
@@ -71,23 +148,89 @@ class ConsoleBuffer {
 
   inline int SwapBuffer(void) { return (current_buffer_ ^= 1); }
 
-  void Draw(void) const;
+  inline void Draw(void) const { DrawTo(GetOutputBackend()); }
+
+  // Writes the current buffer to output instead of the shared backend.
+  inline void DrawTo(OutputBackend& output) const {
+    DrawBuffer(screen_buffer_[current_buffer_],
+               intensity_buffer_[current_buffer_],
+               dirty_extents_[current_buffer_], console_width_,
+               console_height_, shading_mode_, output);
+  }
 
   void Clear(void);
 
+  // Swaps the storage of the current buffer with frame without copying.
+  // Afterwards frame holds what was rendered, and the current buffer takes
+  // over frame's old storage, reallocated if its size does not match.
+  void ExchangeBuffer(Frame& frame);
+
   inline void SetAt(size_t x, size_t y, char c) {
     screen_buffer_[current_buffer_][y][x] = static_cast<wchar_t>(c);
+    MarkDirty(y, x, x + 1);
   }
 
   inline void SetAt(size_t x, size_t y, wchar_t c) {
     screen_buffer_[current_buffer_][y][x] = c;
+    MarkDirty(y, x, x + 1);
+  }
+
+  // Sets columns [begin, end) of row y to c.
+  inline void FillSpan(size_t y, size_t begin, size_t end, wchar_t c) {
+    std::fill(screen_buffer_[current_buffer_][y].begin() + begin,
+              screen_buffer_[current_buffer_][y].begin() + end, c);
+    MarkDirty(y, begin, end);
+  }
+
+  // Every write goes through SetAt/FillSpan, so cells outside this extent
+  // are known to be blank. Clear(), Draw() and FrameRecorder only look at
+  // the extents; intensity is not tracked.
+  inline RowExtent GetDirtyExtent(size_t y) const {
+    return dirty_extents_[current_buffer_][y];
+  }
+
+  inline wchar_t GetAt(size_t x, size_t y) const {
+    return screen_buffer_[current_buffer_][y][x];
+  }
+
+  // Character that Draw() would print at (x, y), with intensity resolved to
+  // the glyph ramp when a shading mode is set.
+  wchar_t GetDisplayedAt(size_t x, size_t y) const;
+
+  inline ShadingMode GetShadingMode(void) const { return shading_mode_; }
+
+  // Intensity is only cleared while shading, so it is dropped on every
+  // change of mode; otherwise coverage from before would come back.
+  inline void SetShadingMode(ShadingMode mode) {
+    if (mode != shading_mode_) {
+      for (auto& intensity : intensity_buffer_) {
+        std::memset(intensity.data(), 0, intensity.size());
+      }
+    }
+    shading_mode_ = mode;
+  }
+
+  inline uint8_t GetIntensityAt(size_t x, size_t y) const {
+    return intensity_buffer_[current_buffer_][y * console_width_ + x];
+  }
+
+  // Accumulates coverage into a cell, saturating at 255.
+  inline void AddIntensityAt(size_t x, size_t y, uint8_t intensity) {
+    uint8_t& cell = intensity_buffer_[current_buffer_][y * console_width_ + x];
+    const unsigned sum = static_cast<unsigned>(cell) + intensity;
+    cell = static_cast<uint8_t>(sum > 255 ? 255 : sum);
   }
 
   void PrintAt(size_t x, size_t y, const std::string_view& s);
 
   void PrintAt(size_t x, size_t y, const std::wstring_view& s);
 
+  inline bool IsHeadless(void) const { return headless_; }
+
   inline int SyncConsoleSize(void) {
+    if (headless_) {
+      return 0;
+    }
     const size_t before_width = console_width_;
     const size_t before_height = console_height_;
     const int ret = GetConsoleSize(console_width_, console_height_);
@@ -100,11 +243,30 @@ class ConsoleBuffer {
 
  protected:
   std::vector<std::vector<wchar_t>> screen_buffer_[2];
+  std::vector<uint8_t> intensity_buffer_[2];
+  std::vector<RowExtent> dirty_extents_[2];
 
  private:
+  static void DrawBuffer(const std::vector<std::vector<wchar_t>>& screen,
+                         const std::vector<uint8_t>& intensity,
+                         const std::vector<RowExtent>& extents, size_t width,
+                         size_t height, ShadingMode shading_mode,
+                         OutputBackend& output);
+
+  static void DrawShadedBuffer(const std::vector<std::vector<wchar_t>>& screen,
+                               const std::vector<uint8_t>& intensity,
+                               size_t width, size_t height,
+                               ShadingMode shading_mode,
+                               OutputBackend& output);
+
+ private:
+  static OutputBackend* output_backend_;
+
   int current_buffer_;
   size_t console_width_;
   size_t console_height_;
+  ShadingMode shading_mode_;
+  bool headless_;
 };
 
 }  // namespace lotate_polyhedron
@@ -1,60 +1,569 @@
 #include "console_coordinate.h"
 
 #include <cmath>
+#include <cstdio>
 
 #include "dot.hpp"
+#include "dot_kernels.h"
 #include "fixed_point.hpp"
 #include "line.hpp"
+#include "stats.h"
 
 namespace lotate_polyhedron {
 
 void ConsoleCoordinate::Draw(void) {
   SwapBuffer();
+  Compose();
+  ConsoleBuffer::Draw();
+}
+
+void ConsoleCoordinate::Compose(void) {
+  Rasterize();
+  if (Stats::kEnabled && stats_overlay_) {
+    Stats::DrawOverlay(*this);
+  }
+  if (probing_) {
+    DrawPickProbe();
+  }
+}
+
+void ConsoleCoordinate::Rasterize(void) {
+  LOTATE_POLYHEDRON_STATS_TIMER(kRasterizeTime);
+  frame_arena_.Reset();
+  if (picking_) {
+    pick_buffer_.assign(GetConsoleWidth() * GetConsoleHeight(),
+                        PickCell{kNoPick, 0, 0});
+  }
+  if (binned_ && GetShadingMode() == ShadingMode::kNone) {
+    RasterizeBinned();
+    return;
+  }
+  if (!viewports_.empty()) {
+    RasterizeViewports();
+    return;
+  }
+  const bool anti_aliased = GetShadingMode() != ShadingMode::kNone;
+  const FloatType cell_size = GetCellSize();
+  const DotType view(0, 0, 1);
+  ArenaVector<DotType> posed{ArenaAllocator<DotType>(frame_arena_)};
+  ArenaVector<DotType> projected{ArenaAllocator<DotType>(frame_arena_)};
   for (size_t i = 0; i < GetShapeCount(); ++i) {
-    for (const auto& line : GetShapeAt(i)) {
-      DrawLineOnBuffer(line);
+    const ShapeType& shape = GetShapeAt(i);
+    FloatType scale;
+    const DotType* vertices = PoseShape(i, posed, scale);
+    if (vertices == nullptr) {
+      continue;
     }
+    if (anti_aliased) {
+      ForEachVisibleEdge(
+          i, vertices, cell_size, scale, view, [&](const auto& element) {
+            DrawLineOnBufferAntiAliased(
+                LineType(vertices[element.first], vertices[element.second]));
+          });
+      continue;
+    }
+    ProjectVertices(vertices, shape.GetDotCount(), projected);
+    ForEachVisibleEdge(
+        i, vertices, cell_size, scale, view, [&](const auto& element) {
+          DrawSegmentOnBuffer(projected[element.first],
+                              projected[element.second], GetScreenRect());
+        });
   }
-  ConsoleBuffer::Draw();
+  RasterizeStaticShapes(nullptr);
 }
 
-void ConsoleCoordinate::DrawLineOnBuffer(const LineType& line) {
-  const FloatType& dx = kDrawDx;
-  // Projection using z=0, so we does not need additional operation/
-  const DotType& zoom_factor =
-      DotType(width_zoom_factor_, height_zoom_factor_, 0.0);
-  const DotType& dot1 =
-      line.dot1.ElementWiseMultiplication(zoom_factor) + origin_;
-  const DotType& dot2 =
-      line.dot2.ElementWiseMultiplication(zoom_factor) + origin_;
+bool ConsoleCoordinate::Pick(size_t x, size_t y, PickHit& hit) const {
+  if (x >= GetConsoleWidth() || y >= GetConsoleHeight() ||
+      pick_buffer_.size() != GetConsoleWidth() * GetConsoleHeight()) {
+    return false;
+  }
+  const PickCell& cell = pick_buffer_[y * GetConsoleWidth() + x];
+  if (cell.shape == kNoPick) {
+    return false;
+  }
+  hit.shape = cell.shape;
+  hit.edge = LineIndicatorType(cell.first, cell.second);
+  return true;
+}
+
+void ConsoleCoordinate::DrawPickProbe(void) {
+  if (GetConsoleHeight() == 0) {
+    return;
+  }
+  // Formatted on the stack so the probe does not allocate every frame.
+  char text[96];
+  PickHit hit;
+  if (Pick(probe_x_, probe_y_, hit)) {
+    snprintf(text, sizeof(text), "pick %zu,%zu: shape %zu edge %zu-%zu",
+             probe_x_, probe_y_, hit.shape,
+             static_cast<size_t>(hit.edge.first),
+             static_cast<size_t>(hit.edge.second));
+  } else {
+    snprintf(text, sizeof(text), "pick %zu,%zu: nothing", probe_x_,
+             probe_y_);
+  }
+  PrintAt(0, GetConsoleHeight() - 1, text);
+}
+
+void ConsoleCoordinate::SetAnimationTrack(size_t idx,
+                                          const AnimationTrack& track) {
+  if (animations_.size() < GetShapeCount()) {
+    animations_.resize(GetShapeCount(),
+                       Animation{AnimationTrack(), FloatType(0.0)});
+  }
+  animations_[idx].track = track;
+  UpdateBoundingRadius(idx);
+}
+
+void ConsoleCoordinate::UpdateBoundingRadius(size_t idx) {
+  if (idx >= animations_.size() || animations_[idx].track.IsEmpty()) {
+    return;
+  }
+  // Half the bounding box diagonal, so no square root is needed.
+  FloatType extent(0.0);
+  for (const auto& vertex : GetShapeAt(idx).GetVertices()) {
+    extent = std::max({extent, abs(vertex.x), abs(vertex.y), abs(vertex.z)});
+  }
+  animations_[idx].bounding_radius = extent * kSqrt3;
+}
+
+AnimationTrack* ConsoleCoordinate::GetAnimationTrack(size_t idx) {
+  if (idx >= animations_.size() || animations_[idx].track.IsEmpty()) {
+    return nullptr;
+  }
+  return &animations_[idx].track;
+}
+
+void ConsoleCoordinate::DeleteShapeAt(size_t idx) {
+  if (idx < animations_.size()) {
+    animations_.erase(animations_.begin() + idx);
+  }
+  Coordinate::DeleteShapeAt(idx);
+}
+
+const ConsoleCoordinate::DotType* ConsoleCoordinate::PoseShape(
+    size_t idx, ArenaVector<DotType>& posed, FloatType& scale_factor) {
+  const auto& vertices = GetShapeAt(idx).GetVertices();
+  scale_factor = FloatType(1.0);
+  if (idx >= animations_.size() || animations_[idx].track.IsEmpty()) {
+    return vertices.data();
+  }
+  Animation& animation = animations_[idx];
+  // Rotation about the origin keeps the bounding sphere in place, so
+  // translation and scale are enough to cull.
+  const AnimationTrack::Vector translation =
+      animation.track.EvaluateTranslation(animation_time_);
+  const AnimationTrack::Vector scale =
+      animation.track.EvaluateScale(animation_time_);
+  const double max_scale = std::max(
+      {std::abs(scale[0]), std::abs(scale[1]), std::abs(scale[2])});
+  scale_factor = FloatType(max_scale);
+  if (!IsSphereOnScreen(
+          DotType(translation[0], translation[1], translation[2]),
+          animation.bounding_radius * FloatType(max_scale))) {
+    return nullptr;
+  }
+
+  LOTATE_POLYHEDRON_STATS_TIMER(kTransformTime);
+  const AnimationTrack::Transform transform = AnimationTrack::MakeTransform(
+      animation.track.EvaluateRotation(animation_time_), translation, scale);
+  posed.resize(vertices.size());
+  for (size_t i = 0; i < vertices.size(); ++i) {
+    posed[i] = transform.Apply(vertices[i]);
+  }
+  LOTATE_POLYHEDRON_STATS_COUNT(kVerticesTransformed, vertices.size());
+  return posed.data();
+}
+
+bool ConsoleCoordinate::IsSphereOnScreen(const DotType& center,
+                                         const FloatType& radius) const {
+  auto overlaps = [](const DotType& projected, const FloatType& cells,
+                     const ScreenRect& rect) {
+    return projected.x + cells >= FloatType(static_cast<int64_t>(rect.left)) &&
+           projected.x - cells <
+               FloatType(static_cast<int64_t>(rect.GetRight())) &&
+           projected.y + cells >= FloatType(static_cast<int64_t>(rect.top)) &&
+           projected.y - cells <
+               FloatType(static_cast<int64_t>(rect.GetBottom()));
+  };
+  if (viewports_.empty()) {
+    const DotType projected =
+        center.ElementWiseMultiplication(
+            DotType(width_zoom_factor_, height_zoom_factor_, 0.0)) +
+        origin_;
+    return overlaps(projected, radius / GetCellSize(), GetScreenRect());
+  }
+  for (const auto& viewport : viewports_) {
+    if (overlaps(viewport.Project(center), radius / viewport.GetCellSize(),
+                 viewport.GetRect())) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void ConsoleCoordinate::ProjectVertices(const DotType* vertices, size_t count,
+                                        ArenaVector<DotType>& projected) {
+  projected.resize(count);
+  const DotType zoom(width_zoom_factor_, height_zoom_factor_, 0.0);
+  if (DotKernels::IsEnabled()) {
+    DotKernels::Project(vertices, projected.data(), count, zoom, origin_);
+    return;
+  }
+  for (size_t i = 0; i < count; ++i) {
+    projected[i] = vertices[i].ElementWiseMultiplication(zoom) + origin_;
+  }
+}
+
+void ConsoleCoordinate::RasterizeViewports(void) {
+  const bool anti_aliased = GetShadingMode() != ShadingMode::kNone;
+  ArenaVector<DotType> posed{ArenaAllocator<DotType>(frame_arena_)};
+  for (size_t i = 0; i < GetShapeCount(); ++i) {
+    const ShapeType& shape = GetShapeAt(i);
+    FloatType scale;
+    const DotType* vertices = PoseShape(i, posed, scale);
+    if (vertices == nullptr) {
+      continue;
+    }
+    ArenaVector<DotType> projected{ArenaAllocator<DotType>(frame_arena_)};
+    projected.reserve(shape.GetDotCount());
+    for (const auto& viewport : viewports_) {
+      // Scene vertices are already transformed; each view only projects
+      // them once and every edge reuses the projected endpoints.
+      projected.clear();
+      for (size_t v = 0; v < shape.GetDotCount(); ++v) {
+        projected.push_back(viewport.Project(vertices[v]));
+      }
+      ForEachVisibleEdge(
+          i, vertices, viewport.GetCellSize(), scale,
+          viewport.GetViewDirection(), [&](const auto& element) {
+            const DotType& dot1 = projected[element.first];
+            const DotType& dot2 = projected[element.second];
+            if (anti_aliased) {
+              DrawSegmentOnBufferAntiAliased(dot1, dot2, viewport.GetRect());
+            } else {
+              DrawSegmentOnBuffer(dot1, dot2, viewport.GetRect());
+            }
+          });
+    }
+  }
+  RasterizeStaticShapes(nullptr);
+}
 
+void ConsoleCoordinate::RasterizeBinned(void) {
+  ArenaVector<RowSpan> spans{ArenaAllocator<RowSpan>(frame_arena_)};
+  ArenaVector<DotType> posed{ArenaAllocator<DotType>(frame_arena_)};
+  if (viewports_.empty()) {
+    const FloatType cell_size = GetCellSize();
+    const DotType view(0, 0, 1);
+    ArenaVector<DotType> projected{ArenaAllocator<DotType>(frame_arena_)};
+    for (size_t i = 0; i < GetShapeCount(); ++i) {
+      const ShapeType& shape = GetShapeAt(i);
+      FloatType scale;
+      const DotType* vertices = PoseShape(i, posed, scale);
+      if (vertices == nullptr) {
+        continue;
+      }
+      ProjectVertices(vertices, shape.GetDotCount(), projected);
+      ForEachVisibleEdge(
+          i, vertices, cell_size, scale, view, [&](const auto& element) {
+            BinSegment(projected[element.first], projected[element.second],
+                       GetScreenRect(), spans);
+          });
+    }
+  } else {
+    for (size_t i = 0; i < GetShapeCount(); ++i) {
+      const ShapeType& shape = GetShapeAt(i);
+      FloatType scale;
+      const DotType* vertices = PoseShape(i, posed, scale);
+      if (vertices == nullptr) {
+        continue;
+      }
+      ArenaVector<DotType> projected{ArenaAllocator<DotType>(frame_arena_)};
+      projected.reserve(shape.GetDotCount());
+      for (const auto& viewport : viewports_) {
+        projected.clear();
+        for (size_t v = 0; v < shape.GetDotCount(); ++v) {
+          projected.push_back(viewport.Project(vertices[v]));
+        }
+        ForEachVisibleEdge(
+            i, vertices, viewport.GetCellSize(), scale,
+            viewport.GetViewDirection(), [&](const auto& element) {
+              BinSegment(projected[element.first], projected[element.second],
+                         viewport.GetRect(), spans);
+            });
+      }
+    }
+  }
+  RasterizeStaticShapes(&spans);
+  FillBinnedSpans(spans);
+}
+
+void ConsoleCoordinate::RasterizeStaticShapes(ArenaVector<RowSpan>* spans) {
+  const bool anti_aliased =
+      spans == nullptr && GetShadingMode() != ShadingMode::kNone;
+  const DotType zoom_factor(width_zoom_factor_, height_zoom_factor_, 0.0);
+  // Static shapes are never picked and do not hide the edges under them.
+  pick_target_ = PickCell{kNoPick, 0, 0};
+  const auto draw = [&](const DotType& dot1, const DotType& dot2,
+                        const ScreenRect& clip) {
+    if (spans != nullptr) {
+      BinSegment(dot1, dot2, clip, *spans);
+    } else if (anti_aliased) {
+      DrawSegmentOnBufferAntiAliased(dot1, dot2, clip);
+    } else {
+      DrawSegmentOnBuffer(dot1, dot2, clip);
+    }
+  };
+  ForEachStaticShape([&](const auto& shape) {
+    if (viewports_.empty()) {
+      // Same projection as ProjectVertices(), keeping scene depth for
+      // shading like DrawLineOnBufferAntiAliased().
+      const auto projected = shape.Map([&](const DotType& vertex) {
+        DotType dot = vertex.ElementWiseMultiplication(zoom_factor) + origin_;
+        dot.z = vertex.z;
+        return dot;
+      });
+      shape.ForEachLineElement([&](const LineIndicatorType& element) {
+        draw(projected[element.first], projected[element.second],
+             GetScreenRect());
+      });
+      return;
+    }
+    for (const auto& viewport : viewports_) {
+      const auto projected = shape.Map(
+          [&viewport](const DotType& vertex) {
+            return viewport.Project(vertex);
+          });
+      shape.ForEachLineElement([&](const LineIndicatorType& element) {
+        draw(projected[element.first], projected[element.second],
+             viewport.GetRect());
+      });
+    }
+  });
+}
+
+void ConsoleCoordinate::BinSegment(const DotType& dot1, const DotType& dot2,
+                                   const ScreenRect& clip,
+                                   ArenaVector<RowSpan>& spans) {
+  LOTATE_POLYHEDRON_STATS_COUNT(kEdgesDrawn, 1);
+  const int64_t left = clip.left;
+  const int64_t right = clip.GetRight();
+  auto push_span = [this, &spans, left, right](int64_t row,
+                                               const FloatType& x0,
+                                               const FloatType& x1) {
+    const int64_t begin =
+        std::max(left, static_cast<int64_t>(round(std::min(x0, x1))));
+    const int64_t end =
+        std::min(right, static_cast<int64_t>(round(std::max(x0, x1))) + 1);
+    if (begin < end) {
+      MarkPicked(row, begin, end);
+      spans.push_back(RowSpan{static_cast<uint32_t>(row),
+                              static_cast<uint32_t>(begin),
+                              static_cast<uint32_t>(end)});
+    }
+  };
+
+  const FloatType min_y = std::min(dot1.y, dot2.y);
+  const FloatType max_y = std::max(dot1.y, dot2.y);
+  const int64_t first_row = static_cast<int64_t>(round(min_y));
+  const int64_t last_row = static_cast<int64_t>(round(max_y));
+  if (first_row == last_row) {
+    if (first_row >= static_cast<int64_t>(clip.top) &&
+        first_row < static_cast<int64_t>(clip.GetBottom())) {
+      push_span(first_row, dot1.x, dot2.x);
+    }
+    return;
+  }
+
+  // Each row takes the part of the segment with y in [row - 0.5, row + 0.5).
+  const FloatType half(0.5);
+  const FloatType dxdy = (dot2.x - dot1.x) / (dot2.y - dot1.y);
+  const int64_t row_begin =
+      std::max(first_row, static_cast<int64_t>(clip.top));
+  const int64_t row_end =
+      std::min(last_row + 1, static_cast<int64_t>(clip.GetBottom()));
+  for (int64_t row = row_begin; row < row_end; ++row) {
+    const FloatType low = std::max(min_y, FloatType(row) - half);
+    const FloatType high = std::min(max_y, FloatType(row) + half);
+    push_span(row, dot1.x + (low - dot1.y) * dxdy,
+              dot1.x + (high - dot1.y) * dxdy);
+  }
+}
+
+void ConsoleCoordinate::FillBinnedSpans(const ArenaVector<RowSpan>& spans) {
+  // Counting sort by row, so rows are written in memory order.
+  const size_t height = GetConsoleHeight();
+  size_t* row_start = frame_arena_.AllocateArray<size_t>(height + 1);
+  std::fill(row_start, row_start + height + 1, 0);
+  for (const auto& span : spans) {
+    ++row_start[span.row + 1];
+  }
+  for (size_t y = 0; y < height; ++y) {
+    row_start[y + 1] += row_start[y];
+  }
+  RowSpan* sorted = frame_arena_.AllocateArray<RowSpan>(spans.size());
+  for (const auto& span : spans) {
+    sorted[row_start[span.row]++] = span;
+  }
+
+  // row_start[y] now holds the end of row y.
+  size_t begin = 0;
+  for (size_t y = 0; y < height; ++y) {
+    for (size_t i = begin; i < row_start[y]; ++i) {
+      FillSpan(y, sorted[i].begin, sorted[i].end, L'*');
+      LOTATE_POLYHEDRON_STATS_COUNT(kCellsWritten,
+                                    sorted[i].end - sorted[i].begin);
+    }
+    begin = row_start[y];
+  }
+}
+
+void ConsoleCoordinate::DrawSegmentOnBuffer(const DotType& dot1,
+                                            const DotType& dot2,
+                                            const ScreenRect& clip) {
+  LOTATE_POLYHEDRON_STATS_COUNT(kEdgesDrawn, 1);
+  const FloatType& dx = kDrawDx;
+  const size_t right = clip.GetRight();
+  const size_t bottom = clip.GetBottom();
   if (abs(dot1.x - dot2.x) < dx) {
     const size_t& x = round(dot1.x);
-    if (x < 0 || x >= GetConsoleWidth()) {
+    if (x < clip.left || x >= right) {
       return;
     }
-    const FloatType& min_y = std::min(dot1.y, dot2.y);
-    const FloatType& max_y = std::max(dot1.y, dot2.y);
-    const FloatType& loop_start = std::max(min_y, FloatType(0));
-    const FloatType& loop_end = std::min(max_y, FloatType(GetConsoleHeight()));
+    const FloatType min_y = std::min(dot1.y, dot2.y);
+    const FloatType max_y = std::max(dot1.y, dot2.y);
+    const FloatType loop_start =
+        std::max(min_y, FloatType(static_cast<int64_t>(clip.top)));
+    const FloatType loop_end =
+        std::min(max_y, FloatType(static_cast<int64_t>(bottom)));
     for (FloatType y = loop_start; y < loop_end; y += 1) {
-      SetAt(x, round(y), '*');
+      const size_t rounded_y = round(y);
+      if (rounded_y >= bottom) {
+        break;
+      }
+      SetAt(x, rounded_y, '*');
+      MarkPicked(rounded_y, x, x + 1);
+      LOTATE_POLYHEDRON_STATS_COUNT(kCellsWritten, 1);
     }
   } else {
     const FloatType& gradient = (dot2.y - dot1.y) / (dot2.x - dot1.x);
     const FloatType& y_intercept = dot1.y - gradient * dot1.x;
-    const FloatType& min_x = std::min(dot1.x, dot2.x);
-    const FloatType& max_x = std::max(dot1.x, dot2.x);
-    const FloatType& loop_start = std::max(min_x, FloatType(0));
-    const FloatType& loop_end = std::min(max_x, FloatType(GetConsoleWidth()));
+    const FloatType min_x = std::min(dot1.x, dot2.x);
+    const FloatType max_x = std::max(dot1.x, dot2.x);
+    const FloatType loop_start =
+        std::max(min_x, FloatType(static_cast<int64_t>(clip.left)));
+    const FloatType loop_end =
+        std::min(max_x, FloatType(static_cast<int64_t>(right)));
     for (FloatType x = loop_start; x < loop_end; x += dx) {
       const size_t& y = round(gradient * x + y_intercept);
-      if (y < 0 || y >= GetConsoleHeight()) {
+      const size_t& rounded_x = round(x);
+      if (y < clip.top || y >= bottom || rounded_x >= right) {
         continue;
       }
-      SetAt(round(x), y, '*');
+      SetAt(rounded_x, y, '*');
+      MarkPicked(y, rounded_x, rounded_x + 1);
+      LOTATE_POLYHEDRON_STATS_COUNT(kCellsWritten, 1);
+    }
+  }
+}
+
+void ConsoleCoordinate::DrawLineOnBufferAntiAliased(const LineType& line) {
+  const DotType& zoom_factor =
+      DotType(width_zoom_factor_, height_zoom_factor_, 0.0);
+  DotType dot1 = line.dot1.ElementWiseMultiplication(zoom_factor) + origin_;
+  DotType dot2 = line.dot2.ElementWiseMultiplication(zoom_factor) + origin_;
+  // Keep scene depth for shading.
+  dot1.z = line.dot1.z;
+  dot2.z = line.dot2.z;
+  DrawSegmentOnBufferAntiAliased(dot1, dot2, GetScreenRect());
+}
+
+void ConsoleCoordinate::DrawSegmentOnBufferAntiAliased(const DotType& dot1,
+                                                       const DotType& dot2,
+                                                       const ScreenRect& clip) {
+  LOTATE_POLYHEDRON_STATS_COUNT(kEdgesDrawn, 1);
+  FloatType x0 = dot1.x, y0 = dot1.y, x1 = dot2.x, y1 = dot2.y;
+  FloatType b0 = GetDepthBrightness(dot1.z);
+  FloatType b1 = GetDepthBrightness(dot2.z);
+
+  // Walk along the major axis; swap so that axis is always "x".
+  const bool steep = abs(y1 - y0) > abs(x1 - x0);
+  if (steep) {
+    std::swap(x0, y0);
+    std::swap(x1, y1);
+  }
+  if (x0 > x1) {
+    std::swap(x0, x1);
+    std::swap(y0, y1);
+    std::swap(b0, b1);
+  }
+
+  const FloatType dx = x1 - x0;
+  const FloatType gradient = dx == FloatType(0) ? FloatType(1) : (y1 - y0) / dx;
+  const FloatType brightness_step =
+      dx == FloatType(0) ? FloatType(0) : (b1 - b0) / dx;
+
+  // Only the part of the major axis inside clip can plot anything; the
+  // interpolation below starts from the clamped x_start.
+  const int64_t major_begin =
+      static_cast<int64_t>(steep ? clip.top : clip.left);
+  const int64_t major_end =
+      static_cast<int64_t>(steep ? clip.GetBottom() : clip.GetRight());
+  const int64_t x_start =
+      std::max(static_cast<int64_t>(round(x0)), major_begin);
+  const int64_t x_end =
+      std::min(static_cast<int64_t>(round(x1)), major_end - 1);
+  if (x_start > x_end) {
+    return;
+  }
+  FloatType intery = y0 + gradient * (FloatType(x_start) - x0);
+  FloatType brightness = b0 + brightness_step * (FloatType(x_start) - x0);
+  for (int64_t x = x_start; x <= x_end; ++x) {
+    const int64_t y = static_cast<int64_t>(floor(intery));
+    const FloatType frac = intery - FloatType(y);
+    const FloatType lower = (FloatType(1) - frac) * brightness;
+    const FloatType upper = frac * brightness;
+    if (steep) {
+      PlotIntensity(y, x, lower, clip);
+      PlotIntensity(y + 1, x, upper, clip);
+    } else {
+      PlotIntensity(x, y, lower, clip);
+      PlotIntensity(x, y + 1, upper, clip);
     }
+    intery += gradient;
+    brightness += brightness_step;
+  }
+}
+
+ConsoleCoordinate::FloatType ConsoleCoordinate::GetDepthBrightness(
+    const FloatType& z) const {
+  if (!depth_shading_) {
+    return FloatType(1);
+  }
+  // Keep far edges visible at a quarter of full intensity.
+  const FloatType min_brightness = FloatType(0.25);
+  FloatType t = (z + depth_range_) / (depth_range_ * FloatType(2));
+  t = std::max(FloatType(0), std::min(FloatType(1), t));
+  return min_brightness + (FloatType(1) - min_brightness) * t;
+}
+
+void ConsoleCoordinate::PlotIntensity(int64_t x, int64_t y,
+                                      const FloatType& coverage,
+                                      const ScreenRect& clip) {
+  if (x < 0 || y < 0 || static_cast<size_t>(x) < clip.left ||
+      static_cast<size_t>(y) < clip.top ||
+      static_cast<size_t>(x) >= clip.GetRight() ||
+      static_cast<size_t>(y) >= clip.GetBottom()) {
+    return;
+  }
+  const int64_t intensity = static_cast<int64_t>(round(coverage * 255));
+  if (intensity <= 0) {
+    return;
   }
+  AddIntensityAt(x, y, static_cast<uint8_t>(std::min<int64_t>(intensity, 255)));
+  MarkPicked(y, x, x + 1);
+  LOTATE_POLYHEDRON_STATS_COUNT(kCellsWritten, 1);
 }
 
 }  // namespace lotate_polyhedron
\ No newline at end of file
@@ -1,48 +1,60 @@
 #ifndef LOTATE_POLYHEDRON_CONSOLE_COORDINATE_H_
 #define LOTATE_POLYHEDRON_CONSOLE_COORDINATE_H_
 
+#include <algorithm>
 #include <cstdint>
+#include <limits>
+#include <tuple>
+#include <vector>
 
+#include "animation_track.h"
+#include "arena.h"
 #include "console_buffer.h"
 #include "coordinate.hpp"
 #include "dot.hpp"
 #include "fixed_point.hpp"
 #include "line.hpp"
 #include "shape_using_eb.hpp"
+#include "static_shape_using_eb.hpp"
+#include "viewport.h"
 
 namespace lotate_polyhedron {
 
+// Static shape types a ConsoleCoordinate can hold. Coordinate and the
+// rasterizer walk this list generically, so a new fixed-size overlay mesh
+// only needs an entry here. Static shapes are drawn by every rasterize path
+// but have no animation track, level of detail or silhouette, and are never
+// picked.
+using ConsoleStaticShapeTypes =
+    std::tuple<StaticElementBufferShape<FixedPoint<32>, 8, 12>,  // Cube
+               StaticElementBufferShape<FixedPoint<32>, 5, 8>,   // Pyramid
+               StaticElementBufferShape<FixedPoint<32>, 4, 3>>;  // Axes
+
 class ConsoleCoordinate
     : public ConsoleBuffer,
-      public Coordinate<FixedPoint<32>,
-                        ElementBufferLineShape<FixedPoint<32>>> {
+      public Coordinate<FixedPoint<32>, ElementBufferLineShape<FixedPoint<32>>,
+                        ConsoleStaticShapeTypes> {
  public:
   using FloatType = FixedPoint<32>;
   using DotType = Dot<FloatType>;
   using LineType = Line<FloatType>;
   using LineIndicatorType = std::pair<size_t, size_t>;
   using ShapeType = ElementBufferLineShape<FloatType>;
+  using StaticCubeType = std::tuple_element_t<0, ConsoleStaticShapeTypes>;
+  using StaticPyramidType = std::tuple_element_t<1, ConsoleStaticShapeTypes>;
+  using StaticAxesType = std::tuple_element_t<2, ConsoleStaticShapeTypes>;
 
  private:
   constexpr static FloatType kDrawDx = FloatType(0.5);
+  constexpr static FloatType kSqrt3 = FloatType(1.73205080757);
   constexpr static int WidthPerHeightZoomFactor = 2;
 
  public:
-  explicit ConsoleCoordinate(void)
-      : ConsoleBuffer(),
-        Coordinate(),
-        width_zoom_factor_(2.0),
-        height_zoom_factor_(1.0) {
-    SetOriginCentor();
-  }
+  explicit ConsoleCoordinate(void) : ConsoleCoordinate(1.0) {}
 
   explicit ConsoleCoordinate(double zoom_factor)
-      : ConsoleBuffer(),
-        Coordinate(),
-        width_zoom_factor_(WidthPerHeightZoomFactor * zoom_factor),
-        height_zoom_factor_(zoom_factor) {
-    SetOriginCentor();
-  }
+      : ConsoleCoordinate(WidthPerHeightZoomFactor * zoom_factor,
+                          zoom_factor) {}
 
   explicit ConsoleCoordinate(double width_zoom_factor,
                              double height_zoom_factor)
@@ -53,23 +65,60 @@ class ConsoleCoordinate
     SetOriginCentor();
   }
 
+  explicit ConsoleCoordinate(size_t width, size_t height, double zoom_factor)
+      : ConsoleBuffer(width, height),
+        Coordinate(),
+        width_zoom_factor_(WidthPerHeightZoomFactor * zoom_factor),
+        height_zoom_factor_(zoom_factor) {
+    SetOriginCentor();
+  }
+
   ConsoleCoordinate(const ConsoleCoordinate& cc)
       : ConsoleBuffer(cc),
         Coordinate(cc),
         origin_(cc.origin_),
         width_zoom_factor_(cc.width_zoom_factor_),
-        height_zoom_factor_(cc.height_zoom_factor_) {}
+        height_zoom_factor_(cc.height_zoom_factor_),
+        depth_shading_(cc.depth_shading_),
+        depth_range_(cc.depth_range_),
+        stats_overlay_(cc.stats_overlay_),
+        binned_(cc.binned_),
+        silhouette_only_(cc.silhouette_only_),
+        viewports_(cc.viewports_),
+        animations_(cc.animations_),
+        animation_time_(cc.animation_time_),
+        picking_(cc.picking_),
+        pick_buffer_(cc.pick_buffer_),
+        pick_target_(cc.pick_target_),
+        probing_(cc.probing_),
+        probe_x_(cc.probe_x_),
+        probe_y_(cc.probe_y_) {}
   ConsoleCoordinate(ConsoleCoordinate&& cc)
       : ConsoleBuffer(std::move(cc)),
         Coordinate(std::move(cc)),
         origin_(std::move(cc.origin_)),
         width_zoom_factor_(cc.width_zoom_factor_),
-        height_zoom_factor_(cc.height_zoom_factor_) {}
+        height_zoom_factor_(cc.height_zoom_factor_),
+        depth_shading_(cc.depth_shading_),
+        depth_range_(cc.depth_range_),
+        stats_overlay_(cc.stats_overlay_),
+        binned_(cc.binned_),
+        silhouette_only_(cc.silhouette_only_),
+        viewports_(std::move(cc.viewports_)),
+        animations_(std::move(cc.animations_)),
+        animation_time_(cc.animation_time_),
+        picking_(cc.picking_),
+        pick_buffer_(std::move(cc.pick_buffer_)),
+        pick_target_(cc.pick_target_),
+        probing_(cc.probing_),
+        probe_x_(cc.probe_x_),
+        probe_y_(cc.probe_y_) {}
 
  public:
   inline DotType GetOrigin(void) const { return origin_; }
   inline double GetWidthZoomFactor(void) const { return width_zoom_factor_; }
   inline double GetHeightZoomFactor(void) const { return height_zoom_factor_; }
+  inline bool IsDepthShading(void) const { return depth_shading_; }
 
   inline void SetOriginCentor(void) {
     origin_ = DotType(ConsoleBuffer::GetConsoleWidth() / 2,
@@ -85,21 +134,243 @@ class ConsoleCoordinate
   inline void SetHeightZoomFactor(double factor) {
     height_zoom_factor_ = factor;
   }
+  // Depth shading only applies when a shading mode is set. Dots with z in
+  // [-range, range] fade from dim (far) to full intensity (near).
+  inline void SetDepthShading(bool enable) { depth_shading_ = enable; }
+  inline void SetDepthRange(const FloatType& range) { depth_range_ = range; }
+  // Prints the previous frame's Stats over the scene in Draw(). Has no
+  // effect unless built with LOTATE_POLYHEDRON_STATS.
+  inline void SetStatsOverlay(bool enable) { stats_overlay_ = enable; }
+  // Binned rasterization turns every edge into per-row spans, sorts them by
+  // row and fills rows in order. Output is continuous per row, so it can
+  // differ slightly from the stepping rasterizer. Ignored when shading.
+  inline void SetBinnedRasterization(bool enable) { binned_ = enable; }
+  inline bool IsBinnedRasterization(void) const { return binned_; }
+  // Draws only the outline of shapes with faces (see
+  // ElementBufferLineShape::SetFaces): edges between a face turned towards
+  // the viewer and one turned away. Shapes without faces draw every edge.
+  inline void SetSilhouetteOnly(bool enable) { silhouette_only_ = enable; }
+  inline bool IsSilhouetteOnly(void) const { return silhouette_only_; }
+
+  // With no viewport the whole console is one front view using this
+  // object's origin and zoom. Otherwise each viewport draws the shared scene
+  // into its own rectangle.
+  inline void AddViewport(const Viewport& viewport) {
+    viewports_.push_back(viewport);
+  }
+  inline size_t GetViewportCount(void) const { return viewports_.size(); }
+  inline Viewport& GetViewportAt(size_t idx) { return viewports_[idx]; }
+  inline void ClearViewports(void) { viewports_.clear(); }
+
+  // An animated shape is drawn with its track, evaluated at the animation
+  // time, applied to its vertices; the stored vertices stay untouched. The
+  // track's rotation is only evaluated for shapes whose bounding sphere,
+  // taken from the vertices when the track is set, reaches the screen.
+  void SetAnimationTrack(size_t idx, const AnimationTrack& track);
+  // Must be called after the vertices of shape idx are changed in place,
+  // so an animated shape's bounding sphere covers them again.
+  void UpdateBoundingRadius(size_t idx);
+  // nullptr if shape idx is not animated.
+  AnimationTrack* GetAnimationTrack(size_t idx);
+  inline void SetAnimationTime(double seconds) { animation_time_ = seconds; }
+  inline double GetAnimationTime(void) const { return animation_time_; }
+
+  // Hides Coordinate::DeleteShapeAt to drop the shape's track as well.
+  void DeleteShapeAt(size_t idx);
+
+  // The shape and edge that last drew a cell. The edge is given by its
+  // vertices, so it also names edges of coarser levels of detail.
+  struct PickHit {
+    size_t shape;
+    LineIndicatorType edge;
+  };
+
+  // The pick buffer records, per cell, which shape and edge drew it during
+  // Rasterize(). It is off by default, and while off it is never allocated
+  // or written.
+  inline void SetPickBuffer(bool enable) {
+    picking_ = enable;
+    if (!enable) {
+      pick_buffer_.clear();
+    }
+  }
+  inline bool IsPickBuffer(void) const { return picking_; }
+
+  // Looks up cell (x, y) of the last Rasterize(). Returns false if nothing
+  // was drawn there or the pick buffer is off.
+  bool Pick(size_t x, size_t y, PickHit& hit) const;
+
+  // Prints what Pick() finds in cell (x, y) on the bottom row in Draw(),
+  // which turns the pick buffer on.
+  inline void SetPickProbe(size_t x, size_t y) {
+    SetPickBuffer(true);
+    probing_ = true;
+    probe_x_ = x;
+    probe_y_ = y;
+  }
+
+  inline const Arena& GetFrameArena(void) const { return frame_arena_; }
 
   void Draw(void);
 
+  // Draws every shape into the current buffer without swapping or flushing.
+  void Rasterize(void);
+
+  // Rasterize() plus the stats overlay and pick probe: the whole frame
+  // Draw() shows, without swapping or flushing.
+  void Compose(void);
+
   inline void SyncConsoleSize(void) {
     ConsoleBuffer::SyncConsoleSize();
     SetOriginCentor();
   }
 
  private:
-  void DrawLineOnBuffer(const LineType& line);
+  struct Animation {
+    AnimationTrack track;
+    // Bounds every vertex of the shape before the track is applied.
+    FloatType bounding_radius;
+  };
+
+  struct PickCell {
+    uint32_t shape;
+    uint32_t first;
+    uint32_t second;
+  };
+
+  constexpr static uint32_t kNoPick = std::numeric_limits<uint32_t>::max();
+
+  // Columns [begin, end) of one row covered by an edge.
+  struct RowSpan {
+    uint32_t row;
+    uint32_t begin;
+    uint32_t end;
+  };
+
+  inline ScreenRect GetScreenRect(void) const {
+    return ScreenRect{0, 0, GetConsoleWidth(), GetConsoleHeight()};
+  }
+
+  // Scene distance covered by one console cell along the denser axis; a
+  // level of detail whose error stays below it is indistinguishable.
+  inline FloatType GetCellSize(void) const {
+    return FloatType(1.0 / std::max(width_zoom_factor_, height_zoom_factor_));
+  }
+
+  // Calls function on each edge of shape idx, posed at vertices, to draw:
+  // the silhouette seen along view in silhouette-only mode, otherwise the
+  // coarsest level of detail finer than cell_size. scale is the largest
+  // scale the pose applied, which makes every edge error that much larger.
+  template <typename Function>
+  void ForEachVisibleEdge(size_t idx, const DotType* vertices,
+                          const FloatType& cell_size, const FloatType& scale,
+                          const DotType& view, Function&& function) {
+    const ShapeType& shape = GetShapeAt(idx);
+    auto visit = [this, idx, &function](const LineIndicatorType& element) {
+      if (picking_) {
+        pick_target_ = PickCell{static_cast<uint32_t>(idx),
+                                static_cast<uint32_t>(element.first),
+                                static_cast<uint32_t>(element.second)};
+      }
+      function(element);
+    };
+    if (silhouette_only_ && shape.HasFaces()) {
+      ArenaVector<LineIndicatorType> silhouette{
+          ArenaAllocator<LineIndicatorType>(frame_arena_)};
+      shape.ExtractSilhouette(vertices, view, silhouette);
+      for (const auto& element : silhouette) {
+        visit(element);
+      }
+      return;
+    }
+    const size_t level = shape.SelectLevelOfDetail(
+        scale > FloatType(0.0) ? cell_size / scale : cell_size);
+    for (const auto& element : shape.GetLineElements(level)) {
+      visit(element);
+    }
+  }
+
+  // Records the edge being drawn as the owner of cells [begin, end) of
+  // row y, if the pick buffer is on. Unpickable lines (pick_target_ of
+  // kNoPick) leave the cells to whatever edge drew them before.
+  inline void MarkPicked(size_t y, size_t begin, size_t end) {
+    if (picking_ && pick_target_.shape != kNoPick) {
+      std::fill(pick_buffer_.begin() + y * GetConsoleWidth() + begin,
+                pick_buffer_.begin() + y * GetConsoleWidth() + end,
+                pick_target_);
+    }
+  }
+
+  void DrawPickProbe(void);
+
+  // Vertices of shape idx at the animation time: its stored vertices, or
+  // for an animated shape the track's transform of them, written to posed.
+  // nullptr if the animated shape is entirely off screen. scale is set to
+  // the pose's largest axis scale, 1 for a shape that is not animated.
+  const DotType* PoseShape(size_t idx, ArenaVector<DotType>& posed,
+                           FloatType& scale);
+
+  // True if a sphere in the scene may cover a cell of the console or of a
+  // viewport.
+  bool IsSphereOnScreen(const DotType& center, const FloatType& radius) const;
+
+  // Scales and offsets count vertices into console cells at once.
+  void ProjectVertices(const DotType* vertices, size_t count,
+                       ArenaVector<DotType>& projected);
+
+  void RasterizeViewports(void);
+
+  void RasterizeBinned(void);
+
+  // Draws every static shape after the dynamic ones. spans is the binned
+  // path's span list, or nullptr to draw straight into the buffer.
+  void RasterizeStaticShapes(ArenaVector<RowSpan>* spans);
+
+  // Appends the spans of a segment with endpoints in console cells.
+  void BinSegment(const DotType& dot1, const DotType& dot2,
+                  const ScreenRect& clip, ArenaVector<RowSpan>& spans);
+
+  void FillBinnedSpans(const ArenaVector<RowSpan>& spans);
+
+  // Draws a segment whose endpoints are already in console cells.
+  void DrawSegmentOnBuffer(const DotType& dot1, const DotType& dot2,
+                           const ScreenRect& clip);
+
+  // Xiaolin Wu style rasterizer accumulating coverage into the intensity
+  // buffer instead of writing characters.
+  void DrawLineOnBufferAntiAliased(const LineType& line);
+
+  // As DrawSegmentOnBuffer, with the endpoints' z holding scene depth.
+  void DrawSegmentOnBufferAntiAliased(const DotType& dot1, const DotType& dot2,
+                                      const ScreenRect& clip);
+
+  FloatType GetDepthBrightness(const FloatType& z) const;
+
+  void PlotIntensity(int64_t x, int64_t y, const FloatType& coverage,
+                     const ScreenRect& clip);
 
  private:
   DotType origin_;
   double width_zoom_factor_;
   double height_zoom_factor_;
+  bool depth_shading_ = false;
+  FloatType depth_range_ = FloatType(1.0);
+  bool stats_overlay_ = false;
+  bool binned_ = false;
+  bool silhouette_only_ = false;
+  std::vector<Viewport> viewports_;
+  // Indexed like the shapes; an entry with an empty track is not animated.
+  std::vector<Animation> animations_;
+  double animation_time_ = 0.0;
+  bool picking_ = false;
+  // Cell owners of the last frame, row-major; empty while picking is off.
+  std::vector<PickCell> pick_buffer_;
+  PickCell pick_target_ = {kNoPick, 0, 0};
+  bool probing_ = false;
+  size_t probe_x_ = 0;
+  size_t probe_y_ = 0;
+  // Per-frame temporaries; reset at the start of every Rasterize().
+  Arena frame_arena_;
 };
 
 }  // namespace lotate_polyhedron
@@ -1,12 +1,25 @@
 #ifndef LOTATEPOLYHEDRON_COORDINATE_HPP_
 #define LOTATEPOLYHEDRON_COORDINATE_HPP_
 
+#include <cstddef>
+#include <tuple>
+#include <utility>
 #include <vector>
 
+#include "stats.h"
+
 namespace lotate_polyhedron {
 
-template <typename __FloatType, typename __ShapeType>
-class Coordinate {
+// StaticShapeList is a std::tuple of fixed-size shape types such as
+// StaticElementBufferShape. Each type gets a vector of its own, so they are
+// transformed and drawn without going through ShapeType at all.
+template <typename __FloatType, typename __ShapeType,
+          typename StaticShapeList = std::tuple<>>
+class Coordinate;
+
+template <typename __FloatType, typename __ShapeType,
+          typename... StaticShapeTypes>
+class Coordinate<__FloatType, __ShapeType, std::tuple<StaticShapeTypes...>> {
  private:
   class ShapeIterator {
    private:
@@ -48,7 +61,7 @@ class Coordinate {
   using IteratorType = ShapeIterator;
 
  public:
-  explicit Coordinate(void) : shapes_() {}
+  explicit Coordinate(void) : shapes_(), static_shapes_() {}
 
   inline size_t GetShapeCount(void) const { return shapes_.size(); }
   inline ShapeType& GetShapeAt(size_t idx) { return shapes_[idx]; }
@@ -60,29 +73,110 @@ class Coordinate {
   void AddShpae(ShapeType&& shape) { shapes_.push_back(std::move(shape)); }
 
   void LotateEveryShapeAroundXAxis(const FloatType& angle) {
+    LOTATE_POLYHEDRON_STATS_TIMER(kTransformTime);
     for (auto& shape : shapes_) {
       shape.LotateAroundXAxis(angle);
+      LOTATE_POLYHEDRON_STATS_COUNT(kVerticesTransformed, shape.GetDotCount());
     }
+    ForEachStaticShape([&angle](auto& shape) {
+      shape.LotateAroundXAxis(angle);
+      LOTATE_POLYHEDRON_STATS_COUNT(kVerticesTransformed, shape.GetDotCount());
+    });
   }
 
   void LotateEveryShapeAroundYAxis(const FloatType& angle) {
+    LOTATE_POLYHEDRON_STATS_TIMER(kTransformTime);
     for (auto& shape : shapes_) {
       shape.LotateAroundYAxis(angle);
+      LOTATE_POLYHEDRON_STATS_COUNT(kVerticesTransformed, shape.GetDotCount());
     }
+    ForEachStaticShape([&angle](auto& shape) {
+      shape.LotateAroundYAxis(angle);
+      LOTATE_POLYHEDRON_STATS_COUNT(kVerticesTransformed, shape.GetDotCount());
+    });
   }
 
   void LotateEveryShapeAroundZAxis(const FloatType& angle) {
+    LOTATE_POLYHEDRON_STATS_TIMER(kTransformTime);
     for (auto& shape : shapes_) {
       shape.LotateAroundZAxis(angle);
+      LOTATE_POLYHEDRON_STATS_COUNT(kVerticesTransformed, shape.GetDotCount());
     }
+    ForEachStaticShape([&angle](auto& shape) {
+      shape.LotateAroundZAxis(angle);
+      LOTATE_POLYHEDRON_STATS_COUNT(kVerticesTransformed, shape.GetDotCount());
+    });
   }
 
   inline IteratorType DeleteShape(IteratorType pos) {
     return IteratorType{shapes_.erase(pos.itr_)};
   }
 
+  inline void DeleteShapeAt(size_t idx) {
+    shapes_.erase(shapes_.begin() + idx);
+  }
+
+  template <typename StaticShapeType>
+  inline void AddStaticShape(const StaticShapeType& shape) {
+    GetStaticShapes<StaticShapeType>().push_back(shape);
+  }
+
+  template <typename StaticShapeType>
+  inline size_t GetStaticShapeCount(void) const {
+    return std::get<std::vector<StaticShapeType>>(static_shapes_).size();
+  }
+
+  template <typename StaticShapeType>
+  inline StaticShapeType& GetStaticShapeAt(size_t idx) {
+    return GetStaticShapes<StaticShapeType>()[idx];
+  }
+
+  template <typename StaticShapeType>
+  inline void DeleteStaticShapeAt(size_t idx) {
+    auto& shapes = GetStaticShapes<StaticShapeType>();
+    shapes.erase(shapes.begin() + idx);
+  }
+
+  // Calls function(shape) for every static shape, type by type. function is
+  // usually a generic lambda, instantiated once per static shape type.
+  template <typename Function>
+  void ForEachStaticShape(Function&& function) {
+    std::apply(
+        [&function](auto&... shapes) { (ForEachOf(shapes, function), ...); },
+        static_shapes_);
+  }
+
+  template <typename Function>
+  void ForEachStaticShape(Function&& function) const {
+    std::apply(
+        [&function](const auto&... shapes) {
+          (ForEachOf(shapes, function), ...);
+        },
+        static_shapes_);
+  }
+
+  // Replaces the static shapes with other's, reusing the storage already
+  // allocated here.
+  inline void CopyStaticShapesFrom(const Coordinate& other) {
+    static_shapes_ = other.static_shapes_;
+  }
+
+ private:
+  template <typename StaticShapeType>
+  inline std::vector<StaticShapeType>& GetStaticShapes(void) {
+    return std::get<std::vector<StaticShapeType>>(static_shapes_);
+  }
+
+  template <typename Shapes, typename Function>
+  static inline void ForEachOf(Shapes& shapes, Function& function) {
+    for (auto& shape : shapes) {
+      function(shape);
+    }
+  }
+
  private:
   std::vector<ShapeType> shapes_;
+  std::tuple<std::vector<StaticShapeTypes>...> static_shapes_;
 };
 
 }  // namespace lotate_polyhedron
@@ -2,7 +2,7 @@
 #define thisLOTATEPOLYHEDRON_DOT_HPP_
 
 #include <cmath>
-#include <sstream>
+#include <ostream>
 
 #include "fixed_point.hpp"
 
@@ -94,6 +94,11 @@ struct Dot {
     return x * rhs.x + y * rhs.y + z * rhs.z;
   }
 
+  constexpr inline Dot CrossProduct(const Dot& rhs) const {
+    return Dot{y * rhs.z - z * rhs.y, z * rhs.x - x * rhs.z,
+               x * rhs.y - y * rhs.x};
+  }
+
   constexpr inline bool operator==(const Dot& rhs) {
     return (x == rhs.x) && (y == rhs.y) && (z == rhs.z);
   }
@@ -176,9 +181,7 @@ struct Dot {
   }
 
   friend std::ostream& operator<<(std::ostream& os, const Dot& dot) {
-    std::stringstream ss;
-    ss << '(' << dot.x << ", " << dot.y << ", " << dot.z << ')';
-    os << ss.str();
+    os << '(' << dot.x << ", " << dot.y << ", " << dot.z << ')';
     return os;
   }
 };
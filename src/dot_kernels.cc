@@ -0,0 +1,330 @@
+#include "dot_kernels.h"
+
+#include <algorithm>
+#include <cstring>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#include <immintrin.h>
+#define LOTATE_POLYHEDRON_AVX2_KERNELS
+#endif
+
+namespace lotate_polyhedron {
+
+namespace {
+
+using FloatType = DotKernels::FloatType;
+using DotType = DotKernels::DotType;
+
+inline int64_t ToRaw(const FloatType& value) {
+  int64_t raw;
+  std::memcpy(&raw, &value, sizeof(raw));
+  return raw;
+}
+
+inline int64_t* RawData(DotType* dots) {
+  return reinterpret_cast<int64_t*>(dots);
+}
+
+inline const int64_t* RawData(const DotType* dots) {
+  return reinterpret_cast<const int64_t*>(dots);
+}
+
+inline int64_t MultiplyScalar(int64_t a, int64_t b) {
+  return static_cast<int64_t>((static_cast<__int128>(a) * b) >> 32);
+}
+
+// Rotation in the plane of coordinates kA and kB (0 = x, 1 = y, 2 = z),
+// rounding each product like Dot::LotateAround?AxisSelf() does:
+//   a' = a * c - b * s,     b' = a * s + b * c
+// or, for kMirrored (the y axis),
+//   a' = a * c + b * s,     b' = (-a) * s + b * c
+template <int kA, int kB, bool kMirrored>
+void RotateScalar(int64_t* raw, size_t count, int64_t c, int64_t s) {
+  for (size_t i = 0; i < count; ++i, raw += 3) {
+    const int64_t a = raw[kA];
+    const int64_t b = raw[kB];
+    if (kMirrored) {
+      raw[kA] = MultiplyScalar(a, c) + MultiplyScalar(b, s);
+      raw[kB] = MultiplyScalar(-a, s) + MultiplyScalar(b, c);
+    } else {
+      raw[kA] = MultiplyScalar(a, c) - MultiplyScalar(b, s);
+      raw[kB] = MultiplyScalar(a, s) + MultiplyScalar(b, c);
+    }
+  }
+}
+
+void MultiplyAddScalar(const int64_t* in, int64_t* out, size_t count,
+                       const int64_t* mul, const int64_t* add) {
+  for (size_t i = 0; i < 3 * count; ++i) {
+    out[i] = MultiplyScalar(in[i], mul[i % 3]) + add[i % 3];
+  }
+}
+
+#ifdef LOTATE_POLYHEDRON_AVX2_KERNELS
+
+#define LOTATE_POLYHEDRON_AVX2 __attribute__((target("avx2")))
+
+// Selector for _mm256_permute4x64_epi64: lane i takes element li.
+constexpr int Pick(int l0, int l1, int l2, int l3) {
+  return l0 | (l1 << 2) | (l2 << 4) | (l3 << 6);
+}
+
+// _mm256_blend_epi32 masks taking a 64 bit lane from the second operand.
+constexpr int kLane0 = 0x03;
+constexpr int kLane1 = 0x0C;
+constexpr int kLane2 = 0x30;
+constexpr int kLane3 = 0xC0;
+
+// Four lanes split for Multiply(). With a = ah * 2^32 + al (ah signed, al
+// unsigned) the shifted product is
+//   (ah * bh << 32) + ah * bl + al * bh + (al * bl >> 32)  (mod 2^64),
+// which equals MultiplyScalar(). _mm256_mul_epu32 treats ah as unsigned, so
+// the mixed terms subtract al << 32 wherever the other operand is negative.
+// Splitting once lets constants and values used twice skip the setup.
+struct Operand {
+  __m256i value;
+  __m256i high;
+  __m256i shifted;
+  __m256i negative;
+};
+
+LOTATE_POLYHEDRON_AVX2 inline Operand Split(__m256i value) {
+  return Operand{value, _mm256_srli_epi64(value, 32),
+                 _mm256_slli_epi64(value, 32),
+                 _mm256_cmpgt_epi64(_mm256_setzero_si256(), value)};
+}
+
+LOTATE_POLYHEDRON_AVX2 inline __m256i Multiply(const Operand& a,
+                                               const Operand& b) {
+  const __m256i low_low =
+      _mm256_srli_epi64(_mm256_mul_epu32(a.value, b.value), 32);
+  const __m256i high_low =
+      _mm256_sub_epi64(_mm256_mul_epu32(a.high, b.value),
+                       _mm256_and_si256(a.negative, b.shifted));
+  const __m256i low_high =
+      _mm256_sub_epi64(_mm256_mul_epu32(a.value, b.high),
+                       _mm256_and_si256(b.negative, a.shifted));
+  const __m256i high_high =
+      _mm256_slli_epi64(_mm256_mul_epu32(a.high, b.high), 32);
+  return _mm256_add_epi64(_mm256_add_epi64(high_high, low_low),
+                          _mm256_add_epi64(high_low, low_high));
+}
+
+// Four packed dots are three registers
+//   r0 = x0 y0 z0 x1,  r1 = y1 z1 x2 y2,  r2 = z2 x3 y3 z3
+// transposed into one register per coordinate and back.
+LOTATE_POLYHEDRON_AVX2 inline void LoadDots(const int64_t* raw,
+                                            __m256i (&v)[3]) {
+  const __m256i r0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(raw));
+  const __m256i r1 =
+      _mm256_loadu_si256(reinterpret_cast<const __m256i*>(raw + 4));
+  const __m256i r2 =
+      _mm256_loadu_si256(reinterpret_cast<const __m256i*>(raw + 8));
+  v[0] = _mm256_blend_epi32(
+      _mm256_blend_epi32(_mm256_permute4x64_epi64(r0, Pick(0, 3, 0, 0)), r1,
+                         kLane2),
+      _mm256_permute4x64_epi64(r2, Pick(0, 0, 0, 1)), kLane3);
+  v[1] = _mm256_blend_epi32(
+      _mm256_blend_epi32(_mm256_permute4x64_epi64(r0, Pick(1, 0, 0, 0)),
+                         _mm256_permute4x64_epi64(r1, Pick(0, 0, 3, 0)),
+                         kLane1 | kLane2),
+      _mm256_permute4x64_epi64(r2, Pick(0, 0, 0, 2)), kLane3);
+  v[2] = _mm256_blend_epi32(
+      _mm256_blend_epi32(_mm256_permute4x64_epi64(r0, Pick(2, 0, 0, 0)), r1,
+                         kLane1),
+      _mm256_permute4x64_epi64(r2, Pick(0, 0, 0, 3)), kLane2 | kLane3);
+}
+
+LOTATE_POLYHEDRON_AVX2 inline void StoreDots(const __m256i (&v)[3],
+                                             int64_t* raw) {
+  const __m256i r0 = _mm256_blend_epi32(
+      _mm256_blend_epi32(_mm256_permute4x64_epi64(v[0], Pick(0, 0, 0, 1)),
+                         _mm256_permute4x64_epi64(v[1], Pick(0, 0, 0, 0)),
+                         kLane1),
+      _mm256_permute4x64_epi64(v[2], Pick(0, 0, 0, 0)), kLane2);
+  const __m256i r1 = _mm256_blend_epi32(
+      _mm256_blend_epi32(_mm256_permute4x64_epi64(v[1], Pick(1, 0, 0, 2)),
+                         _mm256_permute4x64_epi64(v[2], Pick(0, 1, 0, 0)),
+                         kLane1),
+      v[0], kLane2);
+  const __m256i r2 = _mm256_blend_epi32(
+      _mm256_blend_epi32(_mm256_permute4x64_epi64(v[2], Pick(2, 0, 0, 3)),
+                         _mm256_permute4x64_epi64(v[0], Pick(0, 3, 0, 0)),
+                         kLane1),
+      _mm256_permute4x64_epi64(v[1], Pick(0, 0, 3, 0)), kLane2);
+  _mm256_storeu_si256(reinterpret_cast<__m256i*>(raw), r0);
+  _mm256_storeu_si256(reinterpret_cast<__m256i*>(raw + 4), r1);
+  _mm256_storeu_si256(reinterpret_cast<__m256i*>(raw + 8), r2);
+}
+
+template <int kA, int kB, bool kMirrored>
+LOTATE_POLYHEDRON_AVX2 void RotateAvx2(int64_t* raw, size_t count, int64_t c,
+                                       int64_t s) {
+  const Operand vc = Split(_mm256_set1_epi64x(c));
+  const Operand vs = Split(_mm256_set1_epi64x(s));
+  size_t i = 0;
+  for (; i + 4 <= count; i += 4, raw += 12) {
+    __m256i v[3];
+    LoadDots(raw, v);
+    const Operand a = Split(v[kA]);
+    const Operand b = Split(v[kB]);
+    if (kMirrored) {
+      const Operand minus_a =
+          Split(_mm256_sub_epi64(_mm256_setzero_si256(), a.value));
+      v[kA] = _mm256_add_epi64(Multiply(a, vc), Multiply(b, vs));
+      v[kB] = _mm256_add_epi64(Multiply(minus_a, vs), Multiply(b, vc));
+    } else {
+      v[kA] = _mm256_sub_epi64(Multiply(a, vc), Multiply(b, vs));
+      v[kB] = _mm256_add_epi64(Multiply(a, vs), Multiply(b, vc));
+    }
+    StoreDots(v, raw);
+  }
+  RotateScalar<kA, kB, kMirrored>(raw, count - i, c, s);
+}
+
+// Per-coordinate constants repeat every three values, so twelve values
+// (four dots) take the three rotations of the constant pattern and no
+// transpose is needed.
+LOTATE_POLYHEDRON_AVX2 void MultiplyAddAvx2(const int64_t* in, int64_t* out,
+                                            size_t count, const int64_t* mul,
+                                            const int64_t* add) {
+  const Operand vm[3] = {
+      Split(_mm256_setr_epi64x(mul[0], mul[1], mul[2], mul[0])),
+      Split(_mm256_setr_epi64x(mul[1], mul[2], mul[0], mul[1])),
+      Split(_mm256_setr_epi64x(mul[2], mul[0], mul[1], mul[2])),
+  };
+  const __m256i va[3] = {
+      _mm256_setr_epi64x(add[0], add[1], add[2], add[0]),
+      _mm256_setr_epi64x(add[1], add[2], add[0], add[1]),
+      _mm256_setr_epi64x(add[2], add[0], add[1], add[2]),
+  };
+  size_t i = 0;
+  for (; i + 4 <= count; i += 4, in += 12, out += 12) {
+    for (int k = 0; k < 3; ++k) {
+      const __m256i v =
+          _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + 4 * k));
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + 4 * k),
+                          _mm256_add_epi64(Multiply(Split(v), vm[k]), va[k]));
+    }
+  }
+  MultiplyAddScalar(in, out, count - i, mul, add);
+}
+
+#undef LOTATE_POLYHEDRON_AVX2
+
+#endif
+
+inline bool HasAvx2(void) {
+#ifdef LOTATE_POLYHEDRON_AVX2_KERNELS
+  return __builtin_cpu_supports("avx2");
+#else
+  return false;
+#endif
+}
+
+}  // namespace
+
+bool DotKernels::enabled_ = false;
+
+DotKernels::Isa DotKernels::isa_ =
+    HasAvx2() ? DotKernels::Isa::kAvx2 : DotKernels::Isa::kScalar;
+
+bool DotKernels::Enable(void) {
+  // Coordinates with fraction bits set in every position, and angles on
+  // both sides of the reduction at pi.
+  constexpr size_t kCount = 13;
+  constexpr double kAngles[] = {0.03, -0.7, 1.5707963267949, 3.0, -3.2, 7.5};
+  DotType dots[kCount];
+  uint64_t state = 0x9E3779B97F4A7C15ull;
+  auto next = [&state](void) {
+    state = state * 6364136223846793005ull + 1442695040888963407ull;
+    return static_cast<double>(static_cast<int64_t>(state >> 20)) / 4.0e9;
+  };
+  for (auto& dot : dots) {
+    dot = DotType(next(), next(), next());
+  }
+  auto same = [](const DotType& a, const DotType& b) {
+    return a.x == b.x && a.y == b.y && a.z == b.z;
+  };
+
+  bool passed = true;
+  for (const double value : kAngles) {
+    const FloatType angle(value);
+    DotType actual[3][kCount];
+    for (auto& rotated : actual) {
+      std::copy(dots, dots + kCount, rotated);
+    }
+    LotateAroundXAxis(actual[0], kCount, angle);
+    LotateAroundYAxis(actual[1], kCount, angle);
+    LotateAroundZAxis(actual[2], kCount, angle);
+    for (size_t i = 0; i < kCount; ++i) {
+      DotType x = dots[i];
+      DotType y = dots[i];
+      DotType z = dots[i];
+      x.LotateAroundXAxisSelf(angle);
+      y.LotateAroundYAxisSelf(angle);
+      z.LotateAroundZAxisSelf(angle);
+      passed &= same(actual[0][i], x) && same(actual[1][i], y) &&
+                same(actual[2][i], z);
+    }
+  }
+  DotType projected[kCount];
+  Project(dots, projected, kCount, dots[0], dots[1]);
+  for (size_t i = 0; i < kCount; ++i) {
+    passed &= same(projected[i],
+                   dots[i].ElementWiseMultiplication(dots[0]) + dots[1]);
+  }
+  enabled_ = passed;
+  return enabled_;
+}
+
+void DotKernels::SetIsa(Isa isa) {
+  isa_ = isa == Isa::kAvx2 && !HasAvx2() ? Isa::kScalar : isa;
+}
+
+void DotKernels::LotateAroundXAxis(DotType* dots, size_t count,
+                                   FloatType angle) {
+  Rotate<1, 2, false>(RawData(dots), count, angle);
+}
+
+void DotKernels::LotateAroundYAxis(DotType* dots, size_t count,
+                                   FloatType angle) {
+  Rotate<0, 2, true>(RawData(dots), count, angle);
+}
+
+void DotKernels::LotateAroundZAxis(DotType* dots, size_t count,
+                                   FloatType angle) {
+  Rotate<0, 1, false>(RawData(dots), count, angle);
+}
+
+template <int kA, int kB, bool kMirrored>
+void DotKernels::Rotate(int64_t* raw, size_t count, FloatType angle) {
+  // Same angle reduction as Dot::LotateAround?AxisSelf().
+  if (abs(angle) >= DotType::kPi) {
+    angle /= DotType::kPi;
+  }
+  const int64_t c = ToRaw(cos(angle));
+  const int64_t s = ToRaw(sin(angle));
+#ifdef LOTATE_POLYHEDRON_AVX2_KERNELS
+  if (isa_ == Isa::kAvx2) {
+    RotateAvx2<kA, kB, kMirrored>(raw, count, c, s);
+    return;
+  }
+#endif
+  RotateScalar<kA, kB, kMirrored>(raw, count, c, s);
+}
+
+void DotKernels::Project(const DotType* in, DotType* out, size_t count,
+                         const DotType& zoom, const DotType& origin) {
+  const int64_t mul[3] = {ToRaw(zoom.x), ToRaw(zoom.y), ToRaw(zoom.z)};
+  const int64_t add[3] = {ToRaw(origin.x), ToRaw(origin.y), ToRaw(origin.z)};
+#ifdef LOTATE_POLYHEDRON_AVX2_KERNELS
+  if (isa_ == Isa::kAvx2) {
+    MultiplyAddAvx2(RawData(in), RawData(out), count, mul, add);
+    return;
+  }
+#endif
+  MultiplyAddScalar(RawData(in), RawData(out), count, mul, add);
+}
+
+}  // namespace lotate_polyhedron
@@ -0,0 +1,75 @@
+#ifndef LOTATE_POLYHEDRON_DOT_KERNELS_H_
+#define LOTATE_POLYHEDRON_DOT_KERNELS_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#include "dot.hpp"
+#include "fixed_point.hpp"
+
+namespace lotate_polyhedron {
+
+// Batch kernels over spans of Dot<FixedPoint<32>>.
+//
+// The kernels work on the raw Q32.32 integers, so a multiply is the 128 bit
+// product shifted right by 32 and truncated to 64 bits. The AVX2 path builds
+// that product from 32 bit multiplies and gives bit-identical results to the
+// scalar path, so output does not depend on the CPU. The path is picked once
+// at startup from the running CPU. tests/dot_kernels_test.cc checks both
+// paths against Dot, i.e. against FixedPoint's own rounding.
+//
+// That raw layout and rounding are assumptions about FixedPoint, so shapes
+// and projection only use the kernels after Enable() has checked them
+// against Dot on the running build; otherwise they use Dot directly.
+class DotKernels {
+ public:
+  using FloatType = FixedPoint<32>;
+  using DotType = Dot<FloatType>;
+
+  enum class Isa { kScalar, kAvx2 };
+
+  static_assert(sizeof(FloatType) == sizeof(int64_t),
+                "FixedPoint<32> must be a bare 64 bit integer");
+  static_assert(sizeof(DotType) == 3 * sizeof(int64_t),
+                "Dot must be three packed coordinates");
+
+ public:
+  // Turns the kernels on if they give exactly Dot's results on a fixed set
+  // of dots and angles. Returns whether they are on.
+  static bool Enable(void);
+
+  inline static void Disable(void) { enabled_ = false; }
+
+  inline static bool IsEnabled(void) { return enabled_; }
+
+  inline static Isa GetIsa(void) { return isa_; }
+
+  // Forces a path, e.g. kScalar to compare against; kAvx2 is ignored on
+  // CPUs without it.
+  static void SetIsa(Isa isa);
+
+  // Same as calling Dot::LotateAround?AxisSelf(angle) on every dot, with
+  // sin and cos evaluated once.
+  static void LotateAroundXAxis(DotType* dots, size_t count, FloatType angle);
+  static void LotateAroundYAxis(DotType* dots, size_t count, FloatType angle);
+  static void LotateAroundZAxis(DotType* dots, size_t count, FloatType angle);
+
+  // out[i] = in[i].ElementWiseMultiplication(zoom) + origin; in and out may
+  // be the same span.
+  static void Project(const DotType* in, DotType* out, size_t count,
+                      const DotType& zoom, const DotType& origin);
+
+ private:
+  // Rotates coordinates kA and kB of count packed dots in raw.
+  template <int kA, int kB, bool kMirrored>
+  static void Rotate(int64_t* raw, size_t count, FloatType angle);
+
+ private:
+  static bool enabled_;
+  static Isa isa_;
+};
+
+}  // namespace lotate_polyhedron
+
+#endif
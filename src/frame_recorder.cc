@@ -0,0 +1,368 @@
+#include "frame_recorder.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "stats.h"
+
+namespace lotate_polyhedron {
+
+namespace {
+
+// Runs of identical changed cells shorter than this are cheaper as literals.
+constexpr size_t kMinFillRun = 3;
+
+// Never drawn, so compared against it every cell counts as changed.
+constexpr wchar_t kUnknownCell = static_cast<wchar_t>(-1);
+
+inline void AppendVarint(std::string& out, uint64_t value) {
+  while (value >= 0x80) {
+    out.push_back(static_cast<char>((value & 0x7F) | 0x80));
+    value >>= 7;
+  }
+  out.push_back(static_cast<char>(value));
+}
+
+}  // namespace
+
+FrameRecorder::FrameRecorder(void)
+    : file_(nullptr),
+      width_(0),
+      height_(0),
+      has_previous_(false),
+      needs_keyframe_(false),
+      dropped_frames_(0),
+      closing_(false) {}
+
+bool FrameRecorder::Open(const std::string& path, bool compress) {
+  Close();
+  // "T" writes the stream through zlib without compressing it.
+  file_ = gzopen(path.c_str(), compress ? "wb" : "wbT");
+  if (file_ == nullptr) {
+    return false;
+  }
+  has_previous_ = false;
+  needs_keyframe_ = false;
+  dropped_frames_ = 0;
+  closing_ = false;
+  pending_.assign(kMagic, kMagicSize);
+  writer_ = std::thread(&FrameRecorder::Write, this);
+  return true;
+}
+
+void FrameRecorder::Close(void) {
+  if (file_ == nullptr) {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    closing_ = true;
+  }
+  cv_.notify_one();
+  writer_.join();
+  gzclose(file_);
+  file_ = nullptr;
+}
+
+void FrameRecorder::Record(const ConsoleBuffer& cb) {
+  if (file_ == nullptr) {
+    return;
+  }
+  LOTATE_POLYHEDRON_STATS_TIMER(kRecordTime);
+  {
+    // While the writer is behind, frames are dropped so memory stays
+    // bounded without the caller waiting.
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (pending_.size() >= kMaxPendingBytes) {
+      ++dropped_frames_;
+      needs_keyframe_ = true;
+      return;
+    }
+  }
+  // The delay is measured from the last recorded frame, so dropped frames
+  // still take their time on playback.
+  const auto now = std::chrono::steady_clock::now();
+  const uint64_t delay_ms =
+      has_previous_ ? std::chrono::duration_cast<std::chrono::milliseconds>(
+                          now - last_time_)
+                          .count()
+                    : 0;
+  last_time_ = now;
+
+  const size_t width = cb.GetConsoleWidth();
+  const size_t height = cb.GetConsoleHeight();
+  if (!has_previous_ || width != width_ || height != height_) {
+    previous_.assign(width * height, L' ');
+    previous_extents_.assign(height, ConsoleBuffer::RowExtent{width, 0});
+    width_ = width;
+    height_ = height;
+    has_previous_ = true;
+  } else if (needs_keyframe_) {
+    // The player still shows the frame before the dropped ones, so every
+    // cell is written.
+    std::fill(previous_.begin(), previous_.end(), kUnknownCell);
+    previous_extents_.assign(height, ConsoleBuffer::RowExtent{0, width});
+  }
+  needs_keyframe_ = false;
+  // Only dirty columns are read; shading can put glyphs anywhere.
+  const bool shaded =
+      cb.GetShadingMode() != ConsoleBuffer::ShadingMode::kNone;
+  current_.resize(width * height);
+  current_extents_.resize(height);
+  for (size_t y = 0; y < height; ++y) {
+    ConsoleBuffer::RowExtent extent =
+        shaded ? ConsoleBuffer::RowExtent{0, width} : cb.GetDirtyExtent(y);
+    if (extent.IsEmpty()) {
+      extent = ConsoleBuffer::RowExtent{width, 0};
+    }
+    current_extents_[y] = extent;
+    wchar_t* row = current_.data() + y * width;
+    if (extent.IsEmpty()) {
+      std::fill_n(row, width, L' ');
+      continue;
+    }
+    std::fill_n(row, extent.begin, L' ');
+    if (shaded) {
+      for (size_t x = extent.begin; x < extent.end; ++x) {
+        row[x] = cb.GetDisplayedAt(x, y);
+      }
+    } else {
+      for (size_t x = extent.begin; x < extent.end; ++x) {
+        row[x] = cb.GetAt(x, y);
+      }
+    }
+    std::fill_n(row + extent.end, width - extent.end, L' ');
+  }
+
+  encoded_.clear();
+  AppendVarint(encoded_, delay_ms);
+  AppendVarint(encoded_, width);
+  AppendVarint(encoded_, height);
+  const size_t size = current_.size();
+  for (size_t i = 0; i < size;) {
+    size_t j = i;
+    if (current_[i] == previous_[i]) {
+      size_t window_end;
+      j = SkipClean(j, window_end);
+      while (j < size) {
+        while (j < window_end && current_[j] == previous_[j]) {
+          ++j;
+        }
+        if (j < window_end) {
+          break;
+        }
+        j = SkipClean(j, window_end);
+      }
+      encoded_.push_back(kOpSkip);
+      AppendVarint(encoded_, j - i);
+    } else {
+      while (j < size && current_[j] != previous_[j]) {
+        ++j;
+      }
+      EncodeChangedRun(i, j);
+    }
+    i = j;
+  }
+  encoded_.push_back(kOpEnd);
+  previous_.swap(current_);
+  previous_extents_.swap(current_extents_);
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    pending_.append(encoded_);
+  }
+  cv_.notify_one();
+}
+
+size_t FrameRecorder::SkipClean(size_t i, size_t& window_end) const {
+  const size_t size = current_.size();
+  while (i < size) {
+    const size_t y = i / width_;
+    const size_t row_begin = y * width_;
+    const size_t begin =
+        std::min(previous_extents_[y].begin, current_extents_[y].begin);
+    const size_t end =
+        std::max(previous_extents_[y].end, current_extents_[y].end);
+    if (begin < end && i < row_begin + end) {
+      window_end = row_begin + end;
+      return std::max(i, row_begin + begin);
+    }
+    i = row_begin + width_;
+  }
+  window_end = size;
+  return size;
+}
+
+void FrameRecorder::EncodeChangedRun(size_t begin, size_t end) {
+  size_t literal_begin = begin;
+  auto flush_literal = [&](size_t literal_end) {
+    if (literal_begin == literal_end) {
+      return;
+    }
+    encoded_.push_back(kOpLiteral);
+    AppendVarint(encoded_, literal_end - literal_begin);
+    for (size_t k = literal_begin; k < literal_end; ++k) {
+      AppendVarint(encoded_, static_cast<uint32_t>(current_[k]));
+    }
+  };
+
+  for (size_t i = begin; i < end;) {
+    size_t j = i + 1;
+    while (j < end && current_[j] == current_[i]) {
+      ++j;
+    }
+    if (j - i >= kMinFillRun) {
+      flush_literal(i);
+      encoded_.push_back(kOpFill);
+      AppendVarint(encoded_, j - i);
+      AppendVarint(encoded_, static_cast<uint32_t>(current_[i]));
+      literal_begin = j;
+    }
+    i = j;
+  }
+  flush_literal(end);
+}
+
+void FrameRecorder::Write(void) {
+  std::string batch;
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    cv_.wait(lock, [this] { return !pending_.empty() || closing_; });
+    if (pending_.empty() && closing_) {
+      break;
+    }
+    batch.swap(pending_);
+    lock.unlock();
+    gzwrite(file_, batch.data(), static_cast<unsigned>(batch.size()));
+    // Keep the file playable up to the last frame if the process is killed.
+    gzflush(file_, Z_SYNC_FLUSH);
+    batch.clear();
+    lock.lock();
+  }
+}
+
+FramePlayer::FramePlayer(void)
+    : file_(nullptr), width_(0), height_(0) {}
+
+bool FramePlayer::Open(const std::string& path) {
+  Close();
+  // zlib reads uncompressed files through unchanged.
+  file_ = gzopen(path.c_str(), "rb");
+  if (file_ == nullptr) {
+    return false;
+  }
+
+  char magic[FrameRecorder::kMagicSize];
+  if (gzread(file_, magic, sizeof(magic)) != sizeof(magic) ||
+      memcmp(magic, FrameRecorder::kMagic, sizeof(magic)) != 0) {
+    Close();
+    return false;
+  }
+  cells_.clear();
+  width_ = 0;
+  height_ = 0;
+  return true;
+}
+
+void FramePlayer::Close(void) {
+  if (file_ == nullptr) {
+    return;
+  }
+  gzclose(file_);
+  file_ = nullptr;
+}
+
+bool FramePlayer::ReadVarint(uint64_t& value) {
+  value = 0;
+  for (int shift = 0; shift < 64; shift += 7) {
+    const int byte = gzgetc(file_);
+    if (byte == -1) {
+      return false;
+    }
+    value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+    if (!(byte & 0x80)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool FramePlayer::ReadFrame(ConsoleBuffer::Frame& frame, uint32_t& delay_ms) {
+  if (file_ == nullptr) {
+    return false;
+  }
+  uint64_t delay, width, height;
+  if (!ReadVarint(delay) || !ReadVarint(width) || !ReadVarint(height) ||
+      width > kMaxFrameSide || height > kMaxFrameSide) {
+    return false;
+  }
+  if (width != width_ || height != height_) {
+    cells_.assign(width * height, L' ');
+    width_ = width;
+    height_ = height;
+  }
+
+  size_t pos = 0;
+  while (true) {
+    const int op = gzgetc(file_);
+    if (op == -1) {
+      return false;
+    }
+    if (op == FrameRecorder::kOpEnd) {
+      break;
+    }
+    uint64_t count, c;
+    if (!ReadVarint(count) || count > cells_.size() - pos) {
+      return false;
+    }
+    switch (op) {
+      case FrameRecorder::kOpSkip:
+        break;
+      case FrameRecorder::kOpFill:
+        if (!ReadVarint(c)) {
+          return false;
+        }
+        std::fill_n(cells_.begin() + pos, count, static_cast<wchar_t>(c));
+        break;
+      case FrameRecorder::kOpLiteral:
+        for (uint64_t k = 0; k < count; ++k) {
+          if (!ReadVarint(c)) {
+            return false;
+          }
+          cells_[pos + k] = static_cast<wchar_t>(c);
+        }
+        break;
+      default:
+        return false;
+    }
+    pos += count;
+  }
+
+  frame.width = width_;
+  frame.height = height_;
+  frame.shading_mode = ConsoleBuffer::ShadingMode::kNone;
+  frame.screen.resize(height_);
+  for (size_t y = 0; y < height_; ++y) {
+    frame.screen[y].assign(cells_.begin() + y * width_,
+                           cells_.begin() + (y + 1) * width_);
+  }
+  delay_ms = static_cast<uint32_t>(delay);
+  return true;
+}
+
+void FramePlayer::Play(void) {
+  ConsoleBuffer::Frame frame;
+  uint32_t delay_ms;
+  while (ReadFrame(frame, delay_ms)) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(delay_ms));
+    ConsoleBuffer::ClearScreen();
+    ConsoleBuffer::DrawFrame(frame);
+  }
+}
+
+}  // namespace lotate_polyhedron
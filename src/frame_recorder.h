@@ -0,0 +1,138 @@
+#ifndef LOTATE_POLYHEDRON_FRAME_RECORDER_H_
+#define LOTATE_POLYHEDRON_FRAME_RECORDER_H_
+
+#include <zlib.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "console_buffer.h"
+
+namespace lotate_polyhedron {
+
+// Records ConsoleBuffer frames into a compact stream file.
+//
+// File layout: the 5 byte magic "LPRF\x01", then one record per frame:
+//   varint delay_ms, varint width, varint height, ops..., kOpEnd
+// Each frame is a delta against the previous one (a blank frame for the
+// first frame or after a resize), written as ops over the cells in row-major
+// order:
+//   kOpSkip n        n unchanged cells
+//   kOpFill n c      n changed cells all equal to c
+//   kOpLiteral n c*  n changed cells given one by one
+// Integers and characters are LEB128 varints.
+//
+// Encoding happens on the caller's thread into a reused scratch string; the
+// bytes are appended to a pending batch and written by a background thread,
+// so Record() never waits on disk I/O. While the batch holds
+// kMaxPendingBytes or more, frames are dropped and counted instead, and the
+// next recorded frame writes every cell so playback resynchronizes.
+class FrameRecorder {
+ public:
+  constexpr static char kMagic[] = "LPRF\x01";
+  constexpr static size_t kMagicSize = 5;
+  constexpr static size_t kMaxPendingBytes = 4 << 20;
+
+  enum Op : uint8_t { kOpEnd = 0, kOpSkip = 1, kOpFill = 2, kOpLiteral = 3 };
+
+ public:
+  explicit FrameRecorder(void);
+
+  FrameRecorder(const FrameRecorder&) = delete;
+  FrameRecorder& operator=(const FrameRecorder&) = delete;
+
+  ~FrameRecorder(void) { Close(); }
+
+ public:
+  // If compress is set, the stream is gzip compressed.
+  // Returns false if the file could not be opened.
+  bool Open(const std::string& path, bool compress = false);
+
+  void Close(void);
+
+  inline bool IsOpen(void) const { return file_ != nullptr; }
+
+  inline uint64_t GetDroppedFrameCount(void) const { return dropped_frames_; }
+
+  void Record(const ConsoleBuffer& cb);
+
+ private:
+  void EncodeChangedRun(size_t begin, size_t end);
+
+  // First cell from i on that is dirty in the previous or the current frame,
+  // or the cell count if there is none; window_end is set to the end of its
+  // row's dirty columns. Every other cell is blank in both frames.
+  size_t SkipClean(size_t i, size_t& window_end) const;
+
+  void Write(void);
+
+ private:
+  gzFile file_;
+
+  std::vector<wchar_t> previous_;
+  std::vector<wchar_t> current_;
+  std::vector<ConsoleBuffer::RowExtent> previous_extents_;
+  std::vector<ConsoleBuffer::RowExtent> current_extents_;
+  size_t width_;
+  size_t height_;
+  std::chrono::steady_clock::time_point last_time_;
+  bool has_previous_;
+  // Set after a dropped frame, whose delta the player never sees.
+  bool needs_keyframe_;
+  uint64_t dropped_frames_;
+  std::string encoded_;
+
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::string pending_;
+  bool closing_;
+  std::thread writer_;
+};
+
+// Reads a stream written by FrameRecorder back into frames.
+class FramePlayer {
+ public:
+  // Larger frames are treated as corrupt rather than allocated.
+  constexpr static uint64_t kMaxFrameSide = 65535;
+
+ public:
+  explicit FramePlayer(void);
+
+  FramePlayer(const FramePlayer&) = delete;
+  FramePlayer& operator=(const FramePlayer&) = delete;
+
+  ~FramePlayer(void) { Close(); }
+
+ public:
+  // Reads both plain and gzip compressed streams.
+  bool Open(const std::string& path);
+
+  void Close(void);
+
+  inline bool IsOpen(void) const { return file_ != nullptr; }
+
+  // Decodes the next frame. Returns false at end of stream or on a corrupt
+  // record.
+  bool ReadFrame(ConsoleBuffer::Frame& frame, uint32_t& delay_ms);
+
+  // Replays every remaining frame on the terminal at the recorded timing.
+  void Play(void);
+
+ private:
+  bool ReadVarint(uint64_t& value);
+
+ private:
+  gzFile file_;
+  std::vector<wchar_t> cells_;
+  size_t width_;
+  size_t height_;
+};
+
+}  // namespace lotate_polyhedron
+
+#endif
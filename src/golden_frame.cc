@@ -0,0 +1,93 @@
+#include "golden_frame.h"
+
+#include <algorithm>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace lotate_polyhedron {
+
+GoldenFrame::GoldenFrame(const ConsoleBuffer& cb) {
+  rows_.resize(cb.GetConsoleHeight());
+  for (size_t y = 0; y < rows_.size(); ++y) {
+    rows_[y].resize(cb.GetConsoleWidth());
+    for (size_t x = 0; x < rows_[y].size(); ++x) {
+      const wchar_t c = cb.GetDisplayedAt(x, y);
+      rows_[y][x] = (c >= 0 && c < 0x80) ? static_cast<char>(c) : '?';
+    }
+  }
+}
+
+bool GoldenFrame::Load(const std::string& path) {
+  std::ifstream file(path);
+  if (!file) {
+    return false;
+  }
+  rows_.clear();
+  std::string row;
+  while (std::getline(file, row)) {
+    rows_.push_back(row);
+  }
+  return true;
+}
+
+bool GoldenFrame::Save(const std::string& path) const {
+  std::ofstream file(path);
+  if (!file) {
+    return false;
+  }
+  for (const auto& row : rows_) {
+    file << row << '\n';
+  }
+  return static_cast<bool>(file);
+}
+
+GoldenFrame::CompareResult GoldenFrame::Compare(
+    const GoldenFrame& actual, const Tolerance& tolerance) const {
+  CompareResult result;
+  result.size_matched = GetWidth() == actual.GetWidth() &&
+                        GetHeight() == actual.GetHeight();
+  if (!result.size_matched) {
+    return result;
+  }
+
+  for (size_t y = 0; y < GetHeight(); ++y) {
+    for (size_t x = 0; x < GetWidth(); ++x) {
+      switch (tolerance.mode) {
+        case ToleranceMode::kExact:
+          if (rows_[y][x] != actual.rows_[y][x]) {
+            ++result.mismatches;
+          }
+          break;
+        case ToleranceMode::kNeighborhood:
+          if (IsInkAt(x, y) && !actual.HasInkNear(x, y, tolerance.radius)) {
+            ++result.mismatches;
+          }
+          if (tolerance.symmetric && actual.IsInkAt(x, y) &&
+              !HasInkNear(x, y, tolerance.radius)) {
+            ++result.mismatches;
+          }
+          break;
+      }
+    }
+  }
+  result.passed = result.mismatches <= tolerance.max_mismatches;
+  return result;
+}
+
+bool GoldenFrame::HasInkNear(size_t x, size_t y, size_t radius) const {
+  const size_t y_begin = y > radius ? y - radius : 0;
+  const size_t y_end = std::min(y + radius + 1, GetHeight());
+  const size_t x_begin = x > radius ? x - radius : 0;
+  const size_t x_end = std::min(x + radius + 1, GetWidth());
+  for (size_t ny = y_begin; ny < y_end; ++ny) {
+    for (size_t nx = x_begin; nx < x_end; ++nx) {
+      if (IsInkAt(nx, ny)) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+}  // namespace lotate_polyhedron
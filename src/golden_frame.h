@@ -0,0 +1,69 @@
+#ifndef LOTATE_POLYHEDRON_GOLDEN_FRAME_H_
+#define LOTATE_POLYHEDRON_GOLDEN_FRAME_H_
+
+#include <string>
+#include <vector>
+
+#include "console_buffer.h"
+
+namespace lotate_polyhedron {
+
+// Snapshot of a ConsoleBuffer as text rows, used to catch silent changes in
+// rasterizer output. Golden files are plain text, one row per line; cells
+// outside ASCII are stored as '?'.
+class GoldenFrame {
+ public:
+  enum class ToleranceMode {
+    // Every cell must match.
+    kExact,
+    // Only ink (non-blank) placement is compared: every ink cell must have
+    // an ink cell within `radius` cells on the other side, and glyphs may
+    // differ. Meant for approximate rasterizers.
+    kNeighborhood,
+  };
+
+  struct Tolerance {
+    ToleranceMode mode = ToleranceMode::kExact;
+    size_t radius = 1;
+    // kNeighborhood only: when false, only ink in the expected frame has to
+    // be matched, so the actual frame may fill gaps the expected one has.
+    bool symmetric = true;
+    // Number of failing cells still accepted.
+    size_t max_mismatches = 0;
+  };
+
+  struct CompareResult {
+    bool passed = false;
+    bool size_matched = false;
+    size_t mismatches = 0;
+  };
+
+ public:
+  explicit GoldenFrame(void) {}
+  explicit GoldenFrame(const ConsoleBuffer& cb);
+
+  inline size_t GetWidth(void) const {
+    return rows_.empty() ? 0 : rows_[0].size();
+  }
+  inline size_t GetHeight(void) const { return rows_.size(); }
+  inline const std::vector<std::string>& GetRows(void) const { return rows_; }
+
+  bool Load(const std::string& path);
+
+  bool Save(const std::string& path) const;
+
+  CompareResult Compare(const GoldenFrame& actual,
+                        const Tolerance& tolerance) const;
+
+ private:
+  inline bool IsInkAt(size_t x, size_t y) const { return rows_[y][x] != ' '; }
+
+  bool HasInkNear(size_t x, size_t y, size_t radius) const;
+
+ private:
+  std::vector<std::string> rows_;
+};
+
+}  // namespace lotate_polyhedron
+
+#endif
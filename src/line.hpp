@@ -3,7 +3,6 @@
 
 #include <cstdint>
 #include <iostream>
-#include <sstream>
 #include <string>
 
 #include "dot.hpp"
@@ -130,9 +129,7 @@ struct Line {
   }
 
   friend std::ostream& operator<<(std::ostream& os, const Line& line) {
-    std::stringstream ss;
-    ss << '<' << line.dot1 << " - " << line.dot2 << '>';
-    os << ss.str();
+    os << '<' << line.dot1 << " - " << line.dot2 << '>';
     return os;
   }
 };
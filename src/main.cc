@@ -1,97 +1,417 @@
+#include <unistd.h>
+
+#include <cerrno>
 #include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <memory>
 #include <thread>
-#include <vector>
 
+#include "batch_renderer.h"
 #include "console_coordinate.h"
+#include "dot_kernels.h"
+#include "frame_recorder.h"
+#include "mesh_generator.hpp"
+#include "output_backend.h"
+#include "render_pipeline.h"
+#include "sample_scenes.h"
+#include "scene_stream.h"
+#include "stats.h"
 
 using namespace lotate_polyhedron;
 
-void AddCubeToCoordinate(ConsoleCoordinate& cc);
+using MeshGeneratorType = MeshGenerator<ConsoleCoordinate::FloatType>;
+
+bool ParseCount(const char* text, size_t& count);
 
-void AddPyramidToCoordinate(ConsoleCoordinate& cc);
+// Set by SIGINT/SIGTERM so the render loops return and the output backend
+// restores the terminal on the way out.
+volatile std::sig_atomic_t g_stop = 0;
 
-int main() {
+void HandleStopSignal(int signal_number) {
+  (void)signal_number;
+  g_stop = 1;
+}
+
+int main(int argc, char* argv[]) {
   ConsoleCoordinate::FastIO();
 
-  ConsoleCoordinate cc(10);
-  AddCubeToCoordinate(cc);
-  AddPyramidToCoordinate(cc);
+  const char* record_path = nullptr;
+  const char* stats_path = nullptr;
+  const char* mesh_spec = nullptr;
+  const char* output_spec = nullptr;
+  const char* stream_spec = nullptr;
+  bool pipelined = false;
+  bool three_views = false;
+  bool binned = false;
+  bool silhouette = false;
+  bool animated = false;
+  bool static_shapes = false;
+  bool axes = false;
+  bool kernels = false;
+  bool shaded = false;
+  ConsoleBuffer::ShadingMode shading_mode = ConsoleBuffer::ShadingMode::kNone;
+  bool depth_shading = false;
+  bool probe = false;
+  size_t probe_x = 0;
+  size_t probe_y = 0;
+  bool batch = false;
+  size_t batch_width = 80;
+  size_t batch_height = 24;
+  BatchRenderer::Options batch_options;
+  for (int i = 1; i < argc; ++i) {
+    const bool has_value = i + 1 < argc;
+    if (has_value && strcmp(argv[i], "--play") == 0) {
+      FramePlayer player;
+      if (!player.Open(argv[i + 1])) {
+        return 1;
+      }
+      player.Play();
+      return 0;
+    } else if (has_value && strcmp(argv[i], "--record") == 0) {
+      record_path = argv[++i];
+    } else if (has_value && strcmp(argv[i], "--stats") == 0) {
+      stats_path = argv[++i];
+    } else if (has_value && strcmp(argv[i], "--mesh") == 0) {
+      // <kind>:<vertex count>, e.g. "icosphere:100000".
+      mesh_spec = argv[++i];
+    } else if (has_value && strcmp(argv[i], "--output") == 0) {
+      // "tty", "null" or a file or pipe path.
+      output_spec = argv[++i];
+    } else if (has_value && strcmp(argv[i], "--stream") == 0) {
+      // Scene updates from stdin ("-") or a Unix socket path.
+      stream_spec = argv[++i];
+    } else if (has_value && strcmp(argv[i], "--batch") == 0) {
+      // Renders <count> frames offline to --output (stdout by default)
+      // instead of running interactively.
+      batch = true;
+      if (!ParseCount(argv[++i], batch_options.frame_count)) {
+        std::cerr << "bad frame count " << argv[i] << std::endl;
+        return 1;
+      }
+    } else if (has_value && strcmp(argv[i], "--size") == 0) {
+      // <width>x<height> of batch frames.
+      if (sscanf(argv[++i], "%zux%zu", &batch_width, &batch_height) != 2) {
+        std::cerr << "bad size " << argv[i] << std::endl;
+        return 1;
+      }
+    } else if (has_value && strcmp(argv[i], "--step") == 0) {
+      // <x>,<y>,<z> radians the batch scene turns per frame.
+      auto& step = batch_options.rotation_step;
+      if (sscanf(argv[++i], "%lf,%lf,%lf", &step[0], &step[1], &step[2]) !=
+          3) {
+        std::cerr << "bad step " << argv[i] << std::endl;
+        return 1;
+      }
+    } else if (has_value && strcmp(argv[i], "--jobs") == 0) {
+      if (!ParseCount(argv[++i], batch_options.jobs)) {
+        std::cerr << "bad job count " << argv[i] << std::endl;
+        return 1;
+      }
+    } else if (has_value && strcmp(argv[i], "--pick") == 0) {
+      // <x>,<y>: shows the shape and edge drawn in that cell every frame.
+      if (sscanf(argv[++i], "%zu,%zu", &probe_x, &probe_y) != 2) {
+        std::cerr << "bad cell " << argv[i] << std::endl;
+        return 1;
+      }
+      probe = true;
+    } else if (has_value && strcmp(argv[i], "--shade") == 0) {
+      // "glyph" draws anti-aliased edges with a glyph ramp, "ansi" with
+      // 256-color grays.
+      const char* mode = argv[++i];
+      if (strcmp(mode, "glyph") == 0) {
+        shading_mode = ConsoleBuffer::ShadingMode::kGlyphRamp;
+      } else if (strcmp(mode, "ansi") == 0) {
+        shading_mode = ConsoleBuffer::ShadingMode::kAnsi256;
+      } else {
+        std::cerr << "unknown shading mode " << mode << std::endl;
+        return 1;
+      }
+      shaded = true;
+    } else if (strcmp(argv[i], "--depth") == 0) {
+      // Dims far edges; shades with the glyph ramp unless --shade is given.
+      depth_shading = true;
+    } else if (strcmp(argv[i], "--ansi") == 0) {
+      batch_options.format = BatchRenderer::Format::kAnsi;
+    } else if (strcmp(argv[i], "--pipeline") == 0) {
+      pipelined = true;
+    } else if (strcmp(argv[i], "--views") == 0) {
+      // Front, top and side views of the same scene side by side.
+      three_views = true;
+    } else if (strcmp(argv[i], "--binned") == 0) {
+      binned = true;
+    } else if (strcmp(argv[i], "--silhouette") == 0) {
+      // Outline only, for meshes with faces (see --mesh).
+      silhouette = true;
+    } else if (strcmp(argv[i], "--static") == 0) {
+      // Cube and pyramid as fixed-size static shapes.
+      static_shapes = true;
+    } else if (strcmp(argv[i], "--axes") == 0) {
+      // Overlays the X, Y and Z axes as a static gizmo.
+      axes = true;
+    } else if (strcmp(argv[i], "--kernels") == 0) {
+      // Batch rotation and projection kernels, if they match Dot here.
+      kernels = true;
+    } else if (strcmp(argv[i], "--animate") == 0) {
+      // Keyframed turntable instead of rotating the vertices every frame.
+      animated = true;
+    }
+  }
+
+  if (kernels && !DotKernels::Enable()) {
+    std::cerr << "batch kernels disagree with FixedPoint; not using them"
+              << std::endl;
+  }
+
+  // Frames go to a non-blocking terminal writer when stdout is a terminal,
+  // and through blocking stdio otherwise. Batch output must not drop
+  // frames, so it always blocks.
+  std::unique_ptr<OutputBackend> output;
+  const std::string output_name(output_spec != nullptr ? output_spec : "");
+  if (output_name == "null") {
+    output = std::make_unique<NullOutput>();
+  } else if (!batch && (output_name == "tty" ||
+                        (output_name.empty() && isatty(STDOUT_FILENO)))) {
+    output = std::make_unique<TtyOutput>();
+  } else if (!output_name.empty()) {
+    auto file_output = std::make_unique<FileOutput>();
+    if (!file_output->Open(output_name)) {
+      std::cerr << "cannot open " << output_name << std::endl;
+      return 1;
+    }
+    output = std::move(file_output);
+  }
+  ConsoleBuffer::SetOutputBackend(output.get());
+  std::signal(SIGINT, HandleStopSignal);
+  std::signal(SIGTERM, HandleStopSignal);
+
+  // --record <path> captures the interactive session; a ".gz" path is
+  // compressed.
+  FrameRecorder recorder;
+  if (record_path != nullptr) {
+    const std::string path(record_path);
+    const bool compress =
+        path.size() > 3 && path.compare(path.size() - 3, 3, ".gz") == 0;
+    if (!recorder.Open(path, compress)) {
+      return 1;
+    }
+  }
+  // Frames the recorder could not keep up with are missing from the file.
+  auto report_dropped_frames = [&recorder](void) {
+    if (recorder.GetDroppedFrameCount() != 0) {
+      std::cerr << "recording dropped " << recorder.GetDroppedFrameCount()
+                << " frames" << std::endl;
+    }
+  };
+
+  // --stats <path> appends a row of the hot-path counters every
+  // kStatsDumpInterval frames, as JSON lines for a ".json" path and CSV
+  // otherwise. Needs a `make STATS=1` build.
+  constexpr uint64_t kStatsDumpInterval = 10;
+  std::ofstream stats_file;
+  bool stats_json = false;
+  if (stats_path != nullptr) {
+    const std::string path(stats_path);
+    stats_json =
+        path.size() > 5 && path.compare(path.size() - 5, 5, ".json") == 0;
+    stats_file.open(path);
+    if (!stats_file) {
+      return 1;
+    }
+    if (!stats_json) {
+      Stats::DumpCsvHeader(stats_file);
+    }
+  }
+
+  // Batch frames have a fixed size, zoomed so the unit-sized scenes fit.
+  ConsoleCoordinate cc = batch ? ConsoleCoordinate(batch_width, batch_height,
+                                                   batch_height / 4.0)
+                               : ConsoleCoordinate(10);
+  cc.SetStatsOverlay(Stats::kEnabled && !batch);
+  cc.SetBinnedRasterization(binned);
+  cc.SetSilhouetteOnly(silhouette);
+  if (depth_shading && !shaded) {
+    shading_mode = ConsoleBuffer::ShadingMode::kGlyphRamp;
+  }
+  cc.SetShadingMode(shading_mode);
+  cc.SetDepthShading(depth_shading);
+  if (probe) {
+    cc.SetPickProbe(probe_x, probe_y);
+  }
+  // With --stream the scene starts empty and still, and is built by the
+  // updates; see src/scene_stream.h for the protocol.
+  SceneStream stream;
+  SceneStream* scene_stream = nullptr;
+  if (stream_spec != nullptr) {
+    const std::string spec(stream_spec);
+    const bool opened =
+        spec == "-" ? stream.Open(STDIN_FILENO) : stream.Listen(spec);
+    if (!opened) {
+      std::cerr << "cannot open " << spec << std::endl;
+      return 1;
+    }
+    scene_stream = &stream;
+  } else if (mesh_spec != nullptr) {
+    const std::string spec(mesh_spec);
+    const size_t colon = spec.find(':');
+    MeshGeneratorType::Kind kind;
+    if (!MeshGeneratorType::ParseKind(spec.substr(0, colon), kind)) {
+      std::cerr << "unknown mesh " << spec << std::endl;
+      return 1;
+    }
+    size_t count = 100;
+    if (colon != std::string::npos &&
+        !ParseCount(spec.c_str() + colon + 1, count)) {
+      std::cerr << "bad vertex count " << spec << std::endl;
+      return 1;
+    }
+    auto shape = MeshGeneratorType::Generate(kind, count);
+    shape.BuildLevelsOfDetail();
+    cc.AddShpae(std::move(shape));
+  } else if (static_shapes) {
+    AddStaticCubeToCoordinate(cc);
+    AddStaticPyramidToCoordinate(cc);
+  } else {
+    AddCubeToCoordinate(cc);
+    AddPyramidToCoordinate(cc);
+  }
+  if (animated) {
+    AddTurntableTracks(cc);
+  }
+  if (axes) {
+    AddStaticAxesToCoordinate(cc);
+  }
+
+  if (batch) {
+    if (scene_stream != nullptr) {
+      std::cerr << "--batch needs a fixed scene, not --stream" << std::endl;
+      return 1;
+    }
+    if (three_views) {
+      SetThreeViews(cc, batch_height / 6.0);
+    }
+    BatchRenderer(cc, batch_options).Render(ConsoleBuffer::GetOutputBackend());
+    ConsoleBuffer::SetOutputBackend(nullptr);
+    return 0;
+  }
+
 
   int64_t sleep_time = 100;
   ConsoleCoordinate::FloatType x(0.03), y(0.03), z(0.03);
-  while (1) {
+  // Takes the updates received since the last frame, including rotation.
+  auto apply_stream = [&x, &y, &z, scene_stream](ConsoleCoordinate& target) {
+    if (scene_stream == nullptr) {
+      return;
+    }
+    scene_stream->Apply(target);
+    x = scene_stream->GetRotation().x;
+    y = scene_stream->GetRotation().y;
+    z = scene_stream->GetRotation().z;
+  };
+  // Moves the scene on to the next frame: animated scenes look up the
+  // current time, others rotate every vertex.
+  const auto start_time = std::chrono::steady_clock::now();
+  auto advance = [&x, &y, &z, animated,
+                  start_time](ConsoleCoordinate& target) {
+    if (animated) {
+      const std::chrono::duration<double> elapsed =
+          std::chrono::steady_clock::now() - start_time;
+      target.SetAnimationTime(elapsed.count());
+      return;
+    }
+    target.LotateEveryShapeAroundXAxis(x);
+    target.LotateEveryShapeAroundYAxis(y);
+    target.LotateEveryShapeAroundZAxis(z);
+  };
+
+  // Writes the last finished frame's stats every kStatsDumpInterval frames.
+  auto dump_stats = [&stats_file, stats_json](void) {
+    const uint64_t frames = Stats::GetFrameCount();
+    if (!stats_file.is_open() || frames == 0 ||
+        frames % kStatsDumpInterval != 0) {
+      return;
+    }
+    if (stats_json) {
+      Stats::DumpJson(stats_file);
+    } else {
+      Stats::DumpCsv(stats_file);
+    }
+    stats_file.flush();
+  };
+
+  if (pipelined) {
+    // Transform and rasterize on one thread, flush the terminal on another.
+    // The producer ends each frame right before the next update, so that is
+    // where the stats are dumped; the flush numbers are those of the last
+    // frame the presenter wrote.
+    auto update = [&apply_stream, &advance, &dump_stats, sleep_time,
+                   three_views](ConsoleCoordinate& target) {
+      dump_stats();
+      apply_stream(target);
+      target.SyncConsoleSize();
+      if (three_views) {
+        SetThreeViews(target, 5);
+      }
+      advance(target);
+      std::this_thread::sleep_for(std::chrono::milliseconds(sleep_time));
+    };
+    auto record = [&recorder](const ConsoleCoordinate& target) {
+      recorder.Record(target);
+    };
+    RenderPipeline pipeline(cc, update, record);
+    pipeline.Start();
+    while (g_stop == 0) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+    pipeline.Stop();
+    ConsoleBuffer::SetOutputBackend(nullptr);
+    report_dropped_frames();
+    return 0;
+  }
+
+  while (g_stop == 0) {
+    apply_stream(cc);
     cc.SyncConsoleSize();
+    if (three_views) {
+      SetThreeViews(cc, 5);
+    }
 
     cc.Clear();
     ConsoleCoordinate::ClearScreen();
 
     cc.Draw();
-    cc.LotateEveryShapeAroundXAxis(x);
-    cc.LotateEveryShapeAroundYAxis(y);
-    cc.LotateEveryShapeAroundZAxis(z);
+    recorder.Record(cc);
+    advance(cc);
 
-    std::this_thread::sleep_for(std::chrono::milliseconds(sleep_time));
+    Stats::EndFrame();
+    dump_stats();
+
+    // Spend the wait finishing a frame the terminal only took part of.
+    const auto next_frame = std::chrono::steady_clock::now() +
+                            std::chrono::milliseconds(sleep_time);
+    ConsoleBuffer::GetOutputBackend().FlushPending(
+        static_cast<int>(sleep_time));
+    std::this_thread::sleep_until(next_frame);
   }
+  ConsoleBuffer::SetOutputBackend(nullptr);
+  report_dropped_frames();
   return 0;
 }
 
-void AddCubeToCoordinate(ConsoleCoordinate& cc) {
-  std::vector<ConsoleCoordinate::DotType> vbo = {
-      // Bottom four dots
-      ConsoleCoordinate::DotType(1, 1, -1),
-      ConsoleCoordinate::DotType(-1, 1, -1),
-      ConsoleCoordinate::DotType(-1, -1, -1),
-      ConsoleCoordinate::DotType(1, -1, -1),
-      // Top four dots
-      ConsoleCoordinate::DotType(1, 1, 1),
-      ConsoleCoordinate::DotType(-1, 1, 1),
-      ConsoleCoordinate::DotType(-1, -1, 1),
-      ConsoleCoordinate::DotType(1, -1, 1),
-  };
-  std::vector<ConsoleCoordinate::LineIndicatorType> ebo = {
-      // Bottom Lines
-      {0, 1},
-      {1, 2},
-      {2, 3},
-      {3, 0},
-      // Top Lines
-      {4, 5},
-      {5, 6},
-      {6, 7},
-      {7, 4},
-      // Pillar Lines
-      {0, 4},
-      {1, 5},
-      {2, 6},
-      {3, 7},
-  };
-  ConsoleCoordinate::ShapeType s(vbo, ebo);
-  cc.AddShpae(s);
+// Parses a whole decimal count; false on anything else.
+bool ParseCount(const char* text, size_t& count) {
+  if (*text < '0' || *text > '9') {
+    return false;
+  }
+  char* end = nullptr;
+  errno = 0;
+  const unsigned long long value = strtoull(text, &end, 10);
+  if (errno != 0 || *end != '\0') {
+    return false;
+  }
+  count = static_cast<size_t>(value);
+  return true;
 }
-
-void AddPyramidToCoordinate(ConsoleCoordinate& cc) {
-  std::vector<ConsoleCoordinate::DotType> vbo = {
-      // Bottom four dots
-      ConsoleCoordinate::DotType(1, 1, -1),
-      ConsoleCoordinate::DotType(-1, 1, -1),
-      ConsoleCoordinate::DotType(-1, -1, -1),
-      ConsoleCoordinate::DotType(1, -1, -1),
-      // Top dot
-      ConsoleCoordinate::DotType(0, 0, 1),
-  };
-  std::vector<ConsoleCoordinate::LineIndicatorType> ebo = {
-      // Bottom Lines
-      {0, 1},
-      {1, 2},
-      {2, 3},
-      {3, 0},
-      // Lines To Top
-      {0, 4},
-      {1, 4},
-      {2, 4},
-      {3, 4},
-
-  };
-  ConsoleCoordinate::ShapeType s(vbo, ebo);
-  cc.AddShpae(s);
-}
\ No newline at end of file
@@ -0,0 +1,423 @@
+#ifndef LOTATEPOLYHEDRON_MESH_GENERATOR_HPP_
+#define LOTATEPOLYHEDRON_MESH_GENERATOR_HPP_
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "arena.h"
+#include "dot.hpp"
+#include "shape_using_eb.hpp"
+
+namespace lotate_polyhedron {
+
+// Parametric meshes for stress and scaling tests. Every generator reserves
+// the exact vertex and edge counts up front and moves the vectors into the
+// shape. Geometry is computed in double and fits in the unit sphere. Closed
+// surfaces also get consistently wound faces for silhouette extraction.
+template <typename __FloatType>
+class MeshGenerator {
+ public:
+  using FloatType = __FloatType;
+  using DotType = Dot<FloatType>;
+  using LineIndicatorType = std::pair<size_t, size_t>;
+  using ShapeType = ElementBufferLineShape<FloatType>;
+  using Position = std::array<double, 3>;
+  using Triangle = std::array<size_t, 3>;
+
+  enum class Kind { kUvSphere, kTorus, kIcosphere, kGrid, kPointCloud };
+
+ private:
+  constexpr static double kPi = 3.14159265358979323846;
+
+ public:
+  // Picks parameters so the mesh has roughly target_vertex_count vertices.
+  static ShapeType Generate(Kind kind, size_t target_vertex_count) {
+    const size_t n = std::max<size_t>(target_vertex_count, 10);
+    switch (kind) {
+      case Kind::kUvSphere: {
+        // rings * segments + 2 with segments = 2 * rings.
+        const size_t rings = std::max<size_t>(
+            2, static_cast<size_t>(std::sqrt((n - 2) / 2.0)));
+        return GenerateUvSphere(rings, 2 * rings);
+      }
+      case Kind::kTorus: {
+        const size_t minor = std::max<size_t>(
+            3, static_cast<size_t>(std::sqrt(n / 4.0)));
+        return GenerateTorus(std::max<size_t>(3, n / minor), minor);
+      }
+      case Kind::kIcosphere: {
+        // 10 * 4^level + 2 vertices.
+        size_t level = 0;
+        while (10 * (size_t(1) << (2 * (level + 1))) + 2 <= n) {
+          ++level;
+        }
+        return GenerateIcosphere(level);
+      }
+      case Kind::kGrid: {
+        const size_t side =
+            std::max<size_t>(2, static_cast<size_t>(std::sqrt(n)));
+        return GenerateGrid(side, side);
+      }
+      case Kind::kPointCloud:
+      default:
+        return GeneratePointCloud(n, 3);
+    }
+  }
+
+  // Returns false if name is not one of
+  // "sphere", "torus", "icosphere", "grid" or "cloud".
+  static bool ParseKind(const std::string& name, Kind& kind) {
+    if (name == "sphere") {
+      kind = Kind::kUvSphere;
+    } else if (name == "torus") {
+      kind = Kind::kTorus;
+    } else if (name == "icosphere") {
+      kind = Kind::kIcosphere;
+    } else if (name == "grid") {
+      kind = Kind::kGrid;
+    } else if (name == "cloud") {
+      kind = Kind::kPointCloud;
+    } else {
+      return false;
+    }
+    return true;
+  }
+
+  // rings >= 2 latitude rings of `segments` vertices plus two poles.
+  static ShapeType GenerateUvSphere(size_t rings, size_t segments) {
+    std::vector<DotType> vertices;
+    std::vector<LineIndicatorType> edges;
+    vertices.reserve(rings * segments + 2);
+    edges.reserve(rings * segments * 2 + segments);
+
+    vertices.push_back(DotType(0.0, 1.0, 0.0));
+    for (size_t r = 0; r < rings; ++r) {
+      const double phi = kPi * (r + 1) / (rings + 1);
+      for (size_t s = 0; s < segments; ++s) {
+        const double theta = 2 * kPi * s / segments;
+        vertices.push_back(DotType(std::sin(phi) * std::cos(theta),
+                                   std::cos(phi),
+                                   std::sin(phi) * std::sin(theta)));
+      }
+    }
+    vertices.push_back(DotType(0.0, -1.0, 0.0));
+
+    const size_t south = vertices.size() - 1;
+    auto ring_vertex = [segments](size_t r, size_t s) {
+      return 1 + r * segments + s % segments;
+    };
+    for (size_t s = 0; s < segments; ++s) {
+      edges.emplace_back(0, ring_vertex(0, s));
+      edges.emplace_back(ring_vertex(rings - 1, s), south);
+    }
+    for (size_t r = 0; r < rings; ++r) {
+      for (size_t s = 0; s < segments; ++s) {
+        edges.emplace_back(ring_vertex(r, s), ring_vertex(r, s + 1));
+        if (r + 1 < rings) {
+          edges.emplace_back(ring_vertex(r, s), ring_vertex(r + 1, s));
+        }
+      }
+    }
+
+    // Each quad is split along a diagonal that is not an edge.
+    std::vector<Triangle> faces;
+    faces.reserve(2 * rings * segments);
+    for (size_t s = 0; s < segments; ++s) {
+      faces.push_back({0, ring_vertex(0, s + 1), ring_vertex(0, s)});
+      faces.push_back(
+          {ring_vertex(rings - 1, s), ring_vertex(rings - 1, s + 1), south});
+    }
+    for (size_t r = 0; r + 1 < rings; ++r) {
+      for (size_t s = 0; s < segments; ++s) {
+        faces.push_back({ring_vertex(r, s), ring_vertex(r, s + 1),
+                         ring_vertex(r + 1, s + 1)});
+        faces.push_back({ring_vertex(r, s), ring_vertex(r + 1, s + 1),
+                         ring_vertex(r + 1, s)});
+      }
+    }
+    ShapeType shape(std::move(vertices), std::move(edges));
+    shape.SetFaces(std::move(faces));
+    return ShapeType(std::move(shape));
+  }
+
+  static ShapeType GenerateTorus(size_t major_segments, size_t minor_segments,
+                                 double minor_radius = 0.3) {
+    const double major_radius = 1.0 - minor_radius;
+    std::vector<DotType> vertices;
+    std::vector<LineIndicatorType> edges;
+    vertices.reserve(major_segments * minor_segments);
+    edges.reserve(major_segments * minor_segments * 2);
+
+    for (size_t i = 0; i < major_segments; ++i) {
+      const double u = 2 * kPi * i / major_segments;
+      for (size_t j = 0; j < minor_segments; ++j) {
+        const double v = 2 * kPi * j / minor_segments;
+        const double r = major_radius + minor_radius * std::cos(v);
+        vertices.push_back(DotType(r * std::cos(u), minor_radius * std::sin(v),
+                                   r * std::sin(u)));
+      }
+    }
+    auto index = [major_segments, minor_segments](size_t i, size_t j) {
+      return (i % major_segments) * minor_segments + j % minor_segments;
+    };
+    std::vector<Triangle> faces;
+    faces.reserve(major_segments * minor_segments * 2);
+    for (size_t i = 0; i < major_segments; ++i) {
+      for (size_t j = 0; j < minor_segments; ++j) {
+        edges.emplace_back(index(i, j), index(i + 1, j));
+        edges.emplace_back(index(i, j), index(i, j + 1));
+        faces.push_back({index(i, j), index(i + 1, j), index(i + 1, j + 1)});
+        faces.push_back({index(i, j), index(i + 1, j + 1), index(i, j + 1)});
+      }
+    }
+    ShapeType shape(std::move(vertices), std::move(edges));
+    shape.SetFaces(std::move(faces));
+    return ShapeType(std::move(shape));
+  }
+
+  // Icosahedron subdivided `level` times: 10 * 4^level + 2 vertices and
+  // 30 * 4^level edges.
+  static ShapeType GenerateIcosphere(size_t level) {
+    const double t = (1.0 + std::sqrt(5.0)) / 2.0;
+    std::vector<Position> positions = {
+        {-1, t, 0}, {1, t, 0},  {-1, -t, 0}, {1, -t, 0},
+        {0, -1, t}, {0, 1, t},  {0, -1, -t}, {0, 1, -t},
+        {t, 0, -1}, {t, 0, 1},  {-t, 0, -1}, {-t, 0, 1},
+    };
+    // Consistently wound, so every edge appears once as (a, b) and once as
+    // (b, a) across its two faces.
+    std::vector<Triangle> faces = {
+        {0, 11, 5}, {0, 5, 1},   {0, 1, 7},   {0, 7, 10}, {0, 10, 11},
+        {1, 5, 9},  {5, 11, 4},  {11, 10, 2}, {10, 7, 6}, {7, 1, 8},
+        {3, 9, 4},  {3, 4, 2},   {3, 2, 6},   {3, 6, 8},  {3, 8, 9},
+        {4, 9, 5},  {2, 4, 11},  {6, 2, 10},  {8, 6, 7},  {9, 8, 1},
+    };
+    const size_t final_vertices = 10 * (size_t(1) << (2 * level)) + 2;
+    positions.reserve(final_vertices);
+    for (auto& p : positions) {
+      Normalize(p);
+    }
+
+    // Midpoint lookups are scratch only, so they live in an arena that is
+    // recycled between levels.
+    Arena arena;
+    for (size_t l = 0; l < level; ++l) {
+      SubdivideIcosphere(positions, faces, arena);
+      arena.Reset();
+    }
+
+    std::vector<DotType> vertices;
+    std::vector<LineIndicatorType> edges;
+    vertices.reserve(positions.size());
+    edges.reserve(faces.size() * 3 / 2);
+    for (const auto& p : positions) {
+      vertices.push_back(DotType(p[0], p[1], p[2]));
+    }
+    for (const auto& f : faces) {
+      for (int k = 0; k < 3; ++k) {
+        if (f[k] < f[(k + 1) % 3]) {
+          edges.emplace_back(f[k], f[(k + 1) % 3]);
+        }
+      }
+    }
+    ShapeType shape(std::move(vertices), std::move(edges));
+    shape.SetFaces(std::move(faces));
+    return ShapeType(std::move(shape));
+  }
+
+  // Flat columns x rows lattice in the z = 0 plane. Both sides span
+  // [-1, 1], so each is raised to at least 2.
+  static ShapeType GenerateGrid(size_t columns, size_t rows) {
+    columns = std::max<size_t>(2, columns);
+    rows = std::max<size_t>(2, rows);
+    std::vector<DotType> vertices;
+    std::vector<LineIndicatorType> edges;
+    vertices.reserve(columns * rows);
+    edges.reserve((columns - 1) * rows + columns * (rows - 1));
+    for (size_t r = 0; r < rows; ++r) {
+      for (size_t c = 0; c < columns; ++c) {
+        vertices.push_back(DotType(2.0 * c / (columns - 1) - 1.0,
+                                   2.0 * r / (rows - 1) - 1.0, 0.0));
+      }
+    }
+    for (size_t r = 0; r < rows; ++r) {
+      for (size_t c = 0; c < columns; ++c) {
+        const size_t i = r * columns + c;
+        if (c + 1 < columns) {
+          edges.emplace_back(i, i + 1);
+        }
+        if (r + 1 < rows) {
+          edges.emplace_back(i, i + columns);
+        }
+      }
+    }
+    return ShapeType(std::move(vertices), std::move(edges));
+  }
+
+  // Uniform random points in [-1, 1]^3, each joined to its k nearest
+  // neighbours. Neighbours are searched in a uniform grid of about two points
+  // per cell, so generation stays near linear in the point count.
+  static ShapeType GeneratePointCloud(size_t count, size_t k,
+                                      uint32_t seed = 1) {
+    std::mt19937 random(seed);
+    std::uniform_real_distribution<double> coordinate(-1.0, 1.0);
+    std::vector<Position> points(count);
+    for (auto& p : points) {
+      p = {coordinate(random), coordinate(random), coordinate(random)};
+    }
+
+    const size_t cells_per_axis = std::max<size_t>(
+        1, static_cast<size_t>(std::cbrt(count / 2.0)));
+    const double cell_size = 2.0 / cells_per_axis;
+    auto cell_of = [cells_per_axis, cell_size](double v) {
+      return std::min(cells_per_axis - 1,
+                      static_cast<size_t>((v + 1.0) / cell_size));
+    };
+    // Counting sort by cell.
+    std::vector<size_t> cell_start(cells_per_axis * cells_per_axis *
+                                       cells_per_axis + 1,
+                                   0);
+    std::vector<size_t> cell_of_point(count);
+    for (size_t i = 0; i < count; ++i) {
+      const auto& p = points[i];
+      cell_of_point[i] =
+          (cell_of(p[2]) * cells_per_axis + cell_of(p[1])) * cells_per_axis +
+          cell_of(p[0]);
+      ++cell_start[cell_of_point[i] + 1];
+    }
+    for (size_t c = 1; c < cell_start.size(); ++c) {
+      cell_start[c] += cell_start[c - 1];
+    }
+    // Reorder the points by cell so each cell is a contiguous index range
+    // and neighbour searches stay cache friendly.
+    {
+      std::vector<Position> sorted(count);
+      std::vector<size_t> cursor(cell_start.begin(), cell_start.end() - 1);
+      for (size_t i = 0; i < count; ++i) {
+        sorted[cursor[cell_of_point[i]]++] = points[i];
+      }
+      points.swap(sorted);
+    }
+
+    std::vector<LineIndicatorType> edges;
+    edges.reserve(count * k);
+    std::vector<std::pair<double, size_t>> nearest;
+    for (size_t i = 0; i < count; ++i) {
+      const auto& p = points[i];
+      const int64_t cx = cell_of(p[0]), cy = cell_of(p[1]), cz = cell_of(p[2]);
+      nearest.clear();
+      // Grow the searched cube of cells until k candidates are found and
+      // no unsearched cell can be closer than the current k-th one.
+      for (int64_t radius = 0;; ++radius) {
+        for (int64_t z = cz - radius; z <= cz + radius; ++z) {
+          for (int64_t y = cy - radius; y <= cy + radius; ++y) {
+            for (int64_t x = cx - radius; x <= cx + radius; ++x) {
+              const bool on_shell = std::abs(x - cx) == radius ||
+                                    std::abs(y - cy) == radius ||
+                                    std::abs(z - cz) == radius;
+              const int64_t n = static_cast<int64_t>(cells_per_axis);
+              if (!on_shell || x < 0 || y < 0 || z < 0 || x >= n || y >= n ||
+                  z >= n) {
+                continue;
+              }
+              const size_t cell = (z * n + y) * n + x;
+              for (size_t j = cell_start[cell]; j < cell_start[cell + 1];
+                   ++j) {
+                if (j != i) {
+                  nearest.emplace_back(SquaredDistance(p, points[j]), j);
+                }
+              }
+            }
+          }
+        }
+        const size_t found = std::min(k, nearest.size());
+        std::partial_sort(nearest.begin(), nearest.begin() + found,
+                          nearest.end());
+        nearest.resize(found);
+        const double reach = radius * cell_size;
+        if (radius >= static_cast<int64_t>(cells_per_axis) ||
+            (found == k && nearest.back().first <= reach * reach)) {
+          break;
+        }
+      }
+      for (const auto& neighbour : nearest) {
+        edges.emplace_back(std::min(i, neighbour.second),
+                           std::max(i, neighbour.second));
+      }
+    }
+    // Mutual neighbours produce the same edge twice.
+    std::sort(edges.begin(), edges.end());
+    edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+
+    std::vector<DotType> vertices;
+    vertices.reserve(count);
+    for (const auto& p : points) {
+      vertices.push_back(DotType(p[0], p[1], p[2]));
+    }
+    return ShapeType(std::move(vertices), std::move(edges));
+  }
+
+ private:
+  // Splits every face in four, adding one normalized vertex per edge.
+  static void SubdivideIcosphere(std::vector<Position>& positions,
+                                 std::vector<Triangle>& faces, Arena& arena) {
+    using MidpointAllocator = ArenaAllocator<std::pair<const uint64_t, size_t>>;
+    std::unordered_map<uint64_t, size_t, std::hash<uint64_t>,
+                       std::equal_to<uint64_t>, MidpointAllocator>
+        midpoints(faces.size() * 3 / 2, std::hash<uint64_t>(),
+                  std::equal_to<uint64_t>(), MidpointAllocator(arena));
+    auto midpoint = [&positions, &midpoints](size_t a, size_t b) {
+      const uint64_t key =
+          (static_cast<uint64_t>(std::min(a, b)) << 32) | std::max(a, b);
+      const auto found = midpoints.find(key);
+      if (found != midpoints.end()) {
+        return found->second;
+      }
+      Position p;
+      for (int k = 0; k < 3; ++k) {
+        p[k] = (positions[a][k] + positions[b][k]) / 2;
+      }
+      Normalize(p);
+      positions.push_back(p);
+      midpoints.emplace(key, positions.size() - 1);
+      return positions.size() - 1;
+    };
+
+    std::vector<Triangle> subdivided;
+    subdivided.reserve(faces.size() * 4);
+    for (const auto& f : faces) {
+      const size_t a = midpoint(f[0], f[1]);
+      const size_t b = midpoint(f[1], f[2]);
+      const size_t c = midpoint(f[2], f[0]);
+      subdivided.push_back({f[0], a, c});
+      subdivided.push_back({f[1], b, a});
+      subdivided.push_back({f[2], c, b});
+      subdivided.push_back({a, b, c});
+    }
+    faces.swap(subdivided);
+  }
+
+  static inline void Normalize(Position& p) {
+    const double length = std::sqrt(p[0] * p[0] + p[1] * p[1] + p[2] * p[2]);
+    for (auto& v : p) {
+      v /= length;
+    }
+  }
+
+  static inline double SquaredDistance(const Position& a, const Position& b) {
+    const double dx = a[0] - b[0], dy = a[1] - b[1], dz = a[2] - b[2];
+    return dx * dx + dy * dy + dz * dz;
+  }
+};
+
+}  // namespace lotate_polyhedron
+
+#endif
@@ -0,0 +1,202 @@
+#include "output_backend.h"
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/uio.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+
+namespace lotate_polyhedron {
+
+bool FileOutput::Open(const std::string& path) {
+  Close();
+  file_ = fopen(path.c_str(), "wb");
+  owned_ = file_ != nullptr;
+  return file_ != nullptr;
+}
+
+void FileOutput::Close(void) {
+  if (file_ == nullptr) {
+    return;
+  }
+  if (owned_) {
+    fclose(file_);
+  } else {
+    fflush(file_);
+  }
+  file_ = nullptr;
+  owned_ = false;
+}
+
+void FileOutput::Write(const char* data, size_t size) {
+  if (file_ != nullptr) {
+    fwrite(data, 1, size, file_);
+  }
+}
+
+void FileOutput::EndFrame(void) {
+  if (file_ != nullptr) {
+    fflush(file_);
+  }
+}
+
+TtyOutput::TtyOutput(int fd, size_t capacity)
+    : fd_(-1),
+      owned_(false),
+      ring_(std::max<size_t>(capacity, 1)),
+      head_(0),
+      tail_(0),
+      staged_(0),
+      written_end_(0),
+      in_frame_(false),
+      overflowed_(false) {
+  const char* name = ttyname(fd);
+  fd_ = open(name != nullptr ? name : "/dev/tty",
+             O_WRONLY | O_NOCTTY | O_NONBLOCK | O_CLOEXEC);
+  owned_ = fd_ >= 0;
+  if (!owned_) {
+    fd_ = fd;
+  }
+}
+
+TtyOutput::~TtyOutput(void) {
+  Drain();
+  if (owned_) {
+    close(fd_);
+  }
+}
+
+void TtyOutput::BeginFrame(void) {
+  in_frame_ = true;
+  overflowed_ = false;
+  Flush();
+  if (frame_ends_.empty()) {
+    return;
+  }
+  // Keep the oldest frame only if the terminal already has part of it.
+  const size_t keep = head_ > written_end_ ? 1 : 0;
+  dropped_frames_ += frame_ends_.size() - keep;
+  tail_ = keep == 1 ? frame_ends_.front() : head_;
+  frame_ends_.resize(keep);
+  staged_ = tail_;
+}
+
+void TtyOutput::Write(const char* data, size_t size) {
+  if (!in_frame_) {
+    BeginFrame();
+  }
+  if (overflowed_) {
+    return;
+  }
+  const size_t capacity = ring_.size();
+  if (staged_ + size - head_ > capacity) {
+    Flush();
+    if (staged_ + size - head_ > capacity) {
+      overflowed_ = true;
+      return;
+    }
+  }
+  const size_t offset = static_cast<size_t>(staged_ % capacity);
+  const size_t first = std::min(size, capacity - offset);
+  std::memcpy(ring_.data() + offset, data, first);
+  std::memcpy(ring_.data(), data + first, size - first);
+  staged_ += size;
+}
+
+void TtyOutput::EndFrame(void) {
+  if (!in_frame_) {
+    BeginFrame();
+  }
+  in_frame_ = false;
+  if (overflowed_) {
+    staged_ = tail_;
+    ++dropped_frames_;
+    return;
+  }
+  tail_ = staged_;
+  frame_ends_.push_back(tail_);
+  Flush();
+}
+
+void TtyOutput::Flush(void) {
+  const size_t capacity = ring_.size();
+  while (head_ < tail_) {
+    const size_t pending = static_cast<size_t>(tail_ - head_);
+    const size_t offset = static_cast<size_t>(head_ % capacity);
+    const size_t first = std::min(pending, capacity - offset);
+    iovec iov[2] = {
+        {ring_.data() + offset, first},
+        {ring_.data(), pending - first},
+    };
+    const ssize_t written = WriteNonBlocking(iov, pending > first ? 2 : 1);
+    if (written < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      if (errno != EAGAIN && errno != EWOULDBLOCK) {
+        // The terminal is gone; nothing committed can be delivered.
+        head_ = tail_;
+      }
+      break;
+    }
+    head_ += static_cast<uint64_t>(written);
+  }
+  size_t done = 0;
+  while (done < frame_ends_.size() && frame_ends_[done] <= head_) {
+    written_end_ = frame_ends_[done++];
+  }
+  frame_ends_.erase(frame_ends_.begin(), frame_ends_.begin() + done);
+}
+
+bool TtyOutput::FlushPending(int timeout_ms) {
+  const auto deadline = std::chrono::steady_clock::now() +
+                        std::chrono::milliseconds(timeout_ms);
+  Flush();
+  while (head_ < tail_) {
+    const auto left = std::chrono::duration_cast<std::chrono::milliseconds>(
+        deadline - std::chrono::steady_clock::now());
+    if (left.count() <= 0) {
+      break;
+    }
+    pollfd pfd = {fd_, POLLOUT, 0};
+    if (poll(&pfd, 1, static_cast<int>(left.count())) < 0 && errno != EINTR) {
+      break;
+    }
+    Flush();
+  }
+  return head_ == tail_;
+}
+
+void TtyOutput::Drain(void) {
+  Flush();
+  while (head_ < tail_) {
+    pollfd pfd = {fd_, POLLOUT, 0};
+    if (poll(&pfd, 1, -1) < 0 && errno != EINTR) {
+      break;
+    }
+    Flush();
+  }
+}
+
+ssize_t TtyOutput::WriteNonBlocking(const iovec* iov, int count) {
+  if (owned_) {
+    return writev(fd_, iov, count);
+  }
+  // The fallback descriptor is shared with the rest of the process, so
+  // O_NONBLOCK is set only around the call and the old flags put back.
+  const int flags = fcntl(fd_, F_GETFL);
+  if (flags < 0 || (flags & O_NONBLOCK) != 0) {
+    return writev(fd_, iov, count);
+  }
+  fcntl(fd_, F_SETFL, flags | O_NONBLOCK);
+  const ssize_t written = writev(fd_, iov, count);
+  const int saved_errno = errno;
+  fcntl(fd_, F_SETFL, flags);
+  errno = saved_errno;
+  return written;
+}
+
+}  // namespace lotate_polyhedron
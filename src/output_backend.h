@@ -0,0 +1,177 @@
+#ifndef LOTATE_POLYHEDRON_OUTPUT_BACKEND_H_
+#define LOTATE_POLYHEDRON_OUTPUT_BACKEND_H_
+
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace lotate_polyhedron {
+
+// Destination of encoded frames. A frame is written as UTF-8 bytes with any
+// number of Write() calls and committed with EndFrame(). A backend may drop
+// whole frames, but never part of one.
+class OutputBackend {
+ public:
+  virtual ~OutputBackend(void) = default;
+
+  virtual void Write(const char* data, size_t size) = 0;
+
+  virtual void EndFrame(void) = 0;
+
+  // Writes out committed bytes the backend still holds, waiting up to
+  // timeout_ms for the destination to take them. Render loops call this
+  // while idle so a frame the destination only took part of is finished
+  // without waiting for the next one. Returns false if bytes remain.
+  virtual bool FlushPending(int timeout_ms) {
+    (void)timeout_ms;
+    return true;
+  }
+
+  inline uint64_t GetDroppedFrameCount(void) const { return dropped_frames_; }
+
+ protected:
+  uint64_t dropped_frames_ = 0;
+};
+
+// Discards everything; for benchmarking without terminal cost.
+class NullOutput : public OutputBackend {
+ public:
+  void Write(const char* data, size_t size) override {
+    (void)data;
+    bytes_ += size;
+  }
+
+  void EndFrame(void) override {}
+
+  inline uint64_t GetByteCount(void) const { return bytes_; }
+
+ private:
+  uint64_t bytes_ = 0;
+};
+
+// Appends everything to a string, e.g. to encode a frame on a worker thread
+// and write it out elsewhere.
+class StringOutput : public OutputBackend {
+ public:
+  void Write(const char* data, size_t size) override {
+    data_.append(data, size);
+  }
+
+  void EndFrame(void) override {}
+
+  inline std::string& GetString(void) { return data_; }
+
+ private:
+  std::string data_;
+};
+
+// Blocking writes through stdio to a file, a pipe or stdout. Nothing is
+// dropped, so a slow reader throttles the caller.
+class FileOutput : public OutputBackend {
+ public:
+  // Writes to file without taking ownership of it.
+  explicit FileOutput(FILE* file) : file_(file), owned_(false) {}
+
+  explicit FileOutput(void) : file_(nullptr), owned_(false) {}
+
+  FileOutput(const FileOutput&) = delete;
+  FileOutput& operator=(const FileOutput&) = delete;
+
+  ~FileOutput(void) override { Close(); }
+
+ public:
+  bool Open(const std::string& path);
+
+  void Close(void);
+
+  inline bool IsOpen(void) const { return file_ != nullptr; }
+
+  void Write(const char* data, size_t size) override;
+
+  void EndFrame(void) override;
+
+ private:
+  FILE* file_;
+  bool owned_;
+};
+
+// Terminal writer that never blocks its caller.
+//
+// Frames are encoded straight into a byte ring and handed to the terminal
+// with writev() on a non-blocking descriptor, at most two iovecs per call
+// when the pending bytes wrap. The descriptor is a fresh open of the
+// terminal, since O_NONBLOCK set on stdout would be shared with stdin,
+// stderr and the shell, and would outlive a crash. Whatever the terminal
+// does not take stays in the ring for the next Flush() or FlushPending().
+// When a new frame
+// starts, committed frames the terminal has not begun are stale and
+// dropped; a frame that has been partly written is always finished first so
+// no escape sequence is cut. If the new frame does not fit next to it, the
+// new frame is dropped.
+class TtyOutput : public OutputBackend {
+ public:
+  constexpr static size_t kDefaultCapacity = 1 << 20;
+
+ public:
+  // Writes to the terminal fd refers to, or the controlling terminal if fd
+  // is not one. If neither can be opened, writes go to fd itself, which is
+  // only made non-blocking for the duration of each writev().
+  explicit TtyOutput(int fd = STDOUT_FILENO,
+                     size_t capacity = kDefaultCapacity);
+
+  TtyOutput(const TtyOutput&) = delete;
+  TtyOutput& operator=(const TtyOutput&) = delete;
+
+  // Drains the ring, blocking if needed, and closes the descriptor.
+  ~TtyOutput(void) override;
+
+ public:
+  void Write(const char* data, size_t size) override;
+
+  void EndFrame(void) override;
+
+  bool FlushPending(int timeout_ms) override;
+
+  // Writes as much of the committed frames as the terminal accepts now.
+  void Flush(void);
+
+  // Waits until every committed frame has been written.
+  void Drain(void);
+
+  inline size_t GetPendingBytes(void) const {
+    return static_cast<size_t>(tail_ - head_);
+  }
+
+ private:
+  void BeginFrame(void);
+
+  // writev() that returns EAGAIN instead of blocking on either descriptor.
+  ssize_t WriteNonBlocking(const iovec* iov, int count);
+
+ private:
+  int fd_;
+  // Whether fd_ is the non-blocking descriptor opened here.
+  bool owned_;
+  std::vector<char> ring_;
+  // Monotonic byte positions; the ring offset is position % capacity.
+  // [head_, tail_) is committed and unwritten, [tail_, staged_) is the frame
+  // being encoded.
+  uint64_t head_;
+  uint64_t tail_;
+  uint64_t staged_;
+  // Ends of the committed frames that are not fully written yet.
+  std::vector<uint64_t> frame_ends_;
+  // End of the last fully written frame.
+  uint64_t written_end_;
+  bool in_frame_;
+  bool overflowed_;
+};
+
+}  // namespace lotate_polyhedron
+
+#endif
@@ -0,0 +1,79 @@
+#include "render_pipeline.h"
+
+#include <mutex>
+#include <thread>
+
+#include "output_backend.h"
+#include "stats.h"
+
+namespace lotate_polyhedron {
+
+void RenderPipeline::Start(void) {
+  if (running_.exchange(true)) {
+    return;
+  }
+  producer_ = std::thread(&RenderPipeline::Produce, this);
+  presenter_ = std::thread(&RenderPipeline::Present, this);
+}
+
+void RenderPipeline::Stop(void) {
+  running_.store(false);
+  Notify();
+  if (producer_.joinable()) {
+    producer_.join();
+  }
+  if (presenter_.joinable()) {
+    presenter_.join();
+  }
+}
+
+void RenderPipeline::Produce(void) {
+  while (running_.load(std::memory_order_relaxed)) {
+    update_(cc_);
+    cc_.Clear();
+    cc_.Compose();
+    if (on_frame_) {
+      on_frame_(cc_);
+    }
+    cc_.ExchangeBuffer(frames_.GetBackBuffer());
+    frames_.Publish();
+    Stats::EndFrame(Stats::kProduceStage);
+    Notify();
+  }
+}
+
+void RenderPipeline::Present(void) {
+  OutputBackend& output = ConsoleBuffer::GetOutputBackend();
+  bool output_idle = true;
+  while (running_.load(std::memory_order_relaxed)) {
+    if (!frames_.Consume()) {
+      if (!output_idle) {
+        // Finish a frame the terminal only took part of, checking for a
+        // newer frame between polls.
+        output_idle = output.FlushPending(kIdleFlushMs);
+        continue;
+      }
+      std::unique_lock<std::mutex> lock(mutex_);
+      published_.wait(lock, [this] {
+        return frames_.HasPublished() ||
+               !running_.load(std::memory_order_relaxed);
+      });
+      continue;
+    }
+    ConsoleBuffer::ClearScreen();
+    ConsoleBuffer::DrawFrame(frames_.GetFrontBuffer());
+    output_idle = output.FlushPending(0);
+    Stats::EndFrame(Stats::kPresentStage);
+  }
+}
+
+void RenderPipeline::Notify(void) {
+  {
+    // Taken so the notification cannot fall between the presenter's check
+    // and its wait.
+    std::lock_guard<std::mutex> lock(mutex_);
+  }
+  published_.notify_one();
+}
+
+}  // namespace lotate_polyhedron
@@ -0,0 +1,81 @@
+#ifndef LOTATE_POLYHEDRON_RENDER_PIPELINE_H_
+#define LOTATE_POLYHEDRON_RENDER_PIPELINE_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+#include "console_buffer.h"
+#include "console_coordinate.h"
+#include "triple_buffer.hpp"
+
+namespace lotate_polyhedron {
+
+// Runs transform/rasterize and terminal output on separate threads.
+// The producer thread calls the update function, composes the frame into the
+// ConsoleCoordinate's buffer, hands it to the optional frame function (e.g.
+// to record it) and publishes it through a triple buffer; the
+// presenter thread sleeps until a frame is published and flushes the newest
+// one. Each thread ends its own stats frame. Frame time becomes
+// max(compute, I/O) instead of their sum, and a slow terminal only causes
+// frames to be skipped.
+class RenderPipeline {
+ public:
+  // How long the idle presenter waits for the terminal to take more of a
+  // partly written frame before checking for a new one.
+  constexpr static int kIdleFlushMs = 2;
+
+ public:
+  using UpdateFunction = std::function<void(ConsoleCoordinate&)>;
+  // Called on the producer thread with every composed frame before it is
+  // published.
+  using FrameFunction = std::function<void(const ConsoleCoordinate&)>;
+
+ public:
+  explicit RenderPipeline(void) = delete;
+  explicit RenderPipeline(ConsoleCoordinate& cc, UpdateFunction update,
+                          FrameFunction on_frame = nullptr)
+      : cc_(cc),
+        update_(std::move(update)),
+        on_frame_(std::move(on_frame)),
+        running_(false) {}
+
+  RenderPipeline(const RenderPipeline&) = delete;
+  RenderPipeline& operator=(const RenderPipeline&) = delete;
+
+  ~RenderPipeline(void) { Stop(); }
+
+ public:
+  inline bool IsRunning(void) const {
+    return running_.load(std::memory_order_relaxed);
+  }
+
+  void Start(void);
+
+  void Stop(void);
+
+ private:
+  void Produce(void);
+
+  void Present(void);
+
+  void Notify(void);
+
+ private:
+  ConsoleCoordinate& cc_;
+  UpdateFunction update_;
+  FrameFunction on_frame_;
+  TripleBuffer<ConsoleBuffer::Frame> frames_;
+  // Wakes the presenter when a frame is published or the pipeline stops.
+  std::mutex mutex_;
+  std::condition_variable published_;
+  std::atomic<bool> running_;
+  std::thread producer_;
+  std::thread presenter_;
+};
+
+}  // namespace lotate_polyhedron
+
+#endif
@@ -0,0 +1,194 @@
+#include "sample_scenes.h"
+
+#include <vector>
+
+#include "animation_track.h"
+#include "viewport.h"
+
+namespace lotate_polyhedron {
+
+namespace {
+
+// The cube and pyramid below, built at compile time. The coordinates are
+// doubles, whose FixedPoint conversion is constexpr.
+constexpr ConsoleCoordinate::StaticCubeType kStaticCube(
+    {
+        // Bottom four dots
+        ConsoleCoordinate::DotType(1.0, 1.0, -1.0),
+        ConsoleCoordinate::DotType(-1.0, 1.0, -1.0),
+        ConsoleCoordinate::DotType(-1.0, -1.0, -1.0),
+        ConsoleCoordinate::DotType(1.0, -1.0, -1.0),
+        // Top four dots
+        ConsoleCoordinate::DotType(1.0, 1.0, 1.0),
+        ConsoleCoordinate::DotType(-1.0, 1.0, 1.0),
+        ConsoleCoordinate::DotType(-1.0, -1.0, 1.0),
+        ConsoleCoordinate::DotType(1.0, -1.0, 1.0),
+    },
+    {{
+        // Bottom Lines
+        {0, 1},
+        {1, 2},
+        {2, 3},
+        {3, 0},
+        // Top Lines
+        {4, 5},
+        {5, 6},
+        {6, 7},
+        {7, 4},
+        // Pillar Lines
+        {0, 4},
+        {1, 5},
+        {2, 6},
+        {3, 7},
+    }});
+
+constexpr ConsoleCoordinate::StaticPyramidType kStaticPyramid(
+    {
+        // Bottom four dots
+        ConsoleCoordinate::DotType(1.0, 1.0, -1.0),
+        ConsoleCoordinate::DotType(-1.0, 1.0, -1.0),
+        ConsoleCoordinate::DotType(-1.0, -1.0, -1.0),
+        ConsoleCoordinate::DotType(1.0, -1.0, -1.0),
+        // Top dot
+        ConsoleCoordinate::DotType(0.0, 0.0, 1.0),
+    },
+    {{
+        // Bottom Lines
+        {0, 1},
+        {1, 2},
+        {2, 3},
+        {3, 0},
+        // Lines To Top
+        {0, 4},
+        {1, 4},
+        {2, 4},
+        {3, 4},
+    }});
+
+// Unit X, Y and Z axes from the origin.
+constexpr ConsoleCoordinate::StaticAxesType kStaticAxes(
+    {
+        ConsoleCoordinate::DotType(0.0, 0.0, 0.0),
+        ConsoleCoordinate::DotType(1.0, 0.0, 0.0),
+        ConsoleCoordinate::DotType(0.0, 1.0, 0.0),
+        ConsoleCoordinate::DotType(0.0, 0.0, 1.0),
+    },
+    {{
+        {0, 1},
+        {0, 2},
+        {0, 3},
+    }});
+
+}  // namespace
+
+void AddCubeToCoordinate(ConsoleCoordinate& cc) {
+  std::vector<ConsoleCoordinate::DotType> vbo = {
+      // Bottom four dots
+      ConsoleCoordinate::DotType(1, 1, -1),
+      ConsoleCoordinate::DotType(-1, 1, -1),
+      ConsoleCoordinate::DotType(-1, -1, -1),
+      ConsoleCoordinate::DotType(1, -1, -1),
+      // Top four dots
+      ConsoleCoordinate::DotType(1, 1, 1),
+      ConsoleCoordinate::DotType(-1, 1, 1),
+      ConsoleCoordinate::DotType(-1, -1, 1),
+      ConsoleCoordinate::DotType(1, -1, 1),
+  };
+  std::vector<ConsoleCoordinate::LineIndicatorType> ebo = {
+      // Bottom Lines
+      {0, 1},
+      {1, 2},
+      {2, 3},
+      {3, 0},
+      // Top Lines
+      {4, 5},
+      {5, 6},
+      {6, 7},
+      {7, 4},
+      // Pillar Lines
+      {0, 4},
+      {1, 5},
+      {2, 6},
+      {3, 7},
+  };
+  ConsoleCoordinate::ShapeType s(vbo, ebo);
+  cc.AddShpae(s);
+}
+
+void AddPyramidToCoordinate(ConsoleCoordinate& cc) {
+  std::vector<ConsoleCoordinate::DotType> vbo = {
+      // Bottom four dots
+      ConsoleCoordinate::DotType(1, 1, -1),
+      ConsoleCoordinate::DotType(-1, 1, -1),
+      ConsoleCoordinate::DotType(-1, -1, -1),
+      ConsoleCoordinate::DotType(1, -1, -1),
+      // Top dot
+      ConsoleCoordinate::DotType(0, 0, 1),
+  };
+  std::vector<ConsoleCoordinate::LineIndicatorType> ebo = {
+      // Bottom Lines
+      {0, 1},
+      {1, 2},
+      {2, 3},
+      {3, 0},
+      // Lines To Top
+      {0, 4},
+      {1, 4},
+      {2, 4},
+      {3, 4},
+
+  };
+  ConsoleCoordinate::ShapeType s(vbo, ebo);
+  cc.AddShpae(s);
+}
+
+void AddStaticCubeToCoordinate(ConsoleCoordinate& cc) {
+  cc.AddStaticShape(kStaticCube);
+}
+
+void AddStaticPyramidToCoordinate(ConsoleCoordinate& cc) {
+  cc.AddStaticShape(kStaticPyramid);
+}
+
+void AddStaticAxesToCoordinate(ConsoleCoordinate& cc) {
+  cc.AddStaticShape(kStaticAxes);
+}
+
+void SetThreeViews(ConsoleCoordinate& cc, double zoom_factor) {
+  const size_t width = cc.GetConsoleWidth() / 3;
+  const size_t height = cc.GetConsoleHeight();
+  const Viewport::Projection projections[] = {
+      Viewport::Projection::kFront,
+      Viewport::Projection::kTop,
+      Viewport::Projection::kSide,
+  };
+  cc.ClearViewports();
+  for (size_t i = 0; i < 3; ++i) {
+    cc.AddViewport(Viewport(ScreenRect{i * width, 0, width, height},
+                            projections[i], zoom_factor));
+  }
+}
+
+void AddTurntableTracks(ConsoleCoordinate& cc) {
+  // One turn around y every 6 s, tilted towards the viewer, while bobbing
+  // and pulsing; shapes are a third of a turn apart.
+  constexpr double kPi = 3.14159265358979323846;
+  for (size_t i = 0; i < cc.GetShapeCount(); ++i) {
+    AnimationTrack track;
+    for (int key = 0; key <= 3; ++key) {
+      track.AddRotationKey(2.0 * key,
+                           AnimationTrack::Quaternion::FromEulerAngles(
+                               0.4, 2 * kPi * (key + i) / 3, 0.0));
+    }
+    track.AddTranslationKey(0.0, {0.0, 0.0, 0.0});
+    track.AddTranslationKey(3.0, {0.0, 0.3, 0.0});
+    track.AddTranslationKey(6.0, {0.0, 0.0, 0.0});
+    track.AddScaleKey(0.0, {1.0, 1.0, 1.0});
+    track.AddScaleKey(3.0, {1.2, 1.2, 1.2});
+    track.AddScaleKey(6.0, {1.0, 1.0, 1.0});
+    track.SetLooping(true);
+    cc.SetAnimationTrack(i, track);
+  }
+}
+
+}  // namespace lotate_polyhedron
@@ -0,0 +1,30 @@
+#ifndef LOTATE_POLYHEDRON_SAMPLE_SCENES_H_
+#define LOTATE_POLYHEDRON_SAMPLE_SCENES_H_
+
+#include "console_coordinate.h"
+
+namespace lotate_polyhedron {
+
+// The unit-sized shapes and views main shows, shared with the tests.
+
+void AddCubeToCoordinate(ConsoleCoordinate& cc);
+
+void AddPyramidToCoordinate(ConsoleCoordinate& cc);
+
+// The same cube and pyramid as static shapes, built at compile time.
+void AddStaticCubeToCoordinate(ConsoleCoordinate& cc);
+
+void AddStaticPyramidToCoordinate(ConsoleCoordinate& cc);
+
+// Unit X, Y and Z axes from the origin, as a static gizmo.
+void AddStaticAxesToCoordinate(ConsoleCoordinate& cc);
+
+// Front, top and side views of the scene side by side.
+void SetThreeViews(ConsoleCoordinate& cc, double zoom_factor);
+
+// Keyframed turntable for every shape in cc.
+void AddTurntableTracks(ConsoleCoordinate& cc);
+
+}  // namespace lotate_polyhedron
+
+#endif
@@ -0,0 +1,305 @@
+#include "scene_stream.h"
+
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <utility>
+
+namespace lotate_polyhedron {
+
+namespace {
+
+constexpr size_t kReadSize = 64 * 1024;
+constexpr int kPollTimeoutMs = 100;
+
+inline uint32_t ReadU32(const char* data) {
+  uint32_t value;
+  std::memcpy(&value, data, sizeof(value));
+  return value;
+}
+
+// Waits up to kPollTimeoutMs for fd to become readable.
+inline bool WaitReadable(int fd) {
+  pollfd pfd = {fd, POLLIN, 0};
+  return poll(&pfd, 1, kPollTimeoutMs) > 0;
+}
+
+}  // namespace
+
+SceneStream::SceneStream(void)
+    : fd_(-1), listen_fd_(-1), running_(false), rotation_() {}
+
+bool SceneStream::Open(int fd) {
+  Close();
+  fd_ = fd;
+  running_.store(true);
+  reader_ = std::thread(&SceneStream::Read, this);
+  return true;
+}
+
+bool SceneStream::Listen(const std::string& path) {
+  Close();
+  sockaddr_un address = {};
+  if (path.size() >= sizeof(address.sun_path)) {
+    return false;
+  }
+  address.sun_family = AF_UNIX;
+  std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+
+  listen_fd_ = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (listen_fd_ < 0) {
+    return false;
+  }
+  unlink(path.c_str());
+  if (bind(listen_fd_, reinterpret_cast<sockaddr*>(&address),
+           sizeof(address)) != 0 ||
+      listen(listen_fd_, 1) != 0) {
+    close(listen_fd_);
+    listen_fd_ = -1;
+    return false;
+  }
+  socket_path_ = path;
+  running_.store(true);
+  reader_ = std::thread(&SceneStream::Read, this);
+  return true;
+}
+
+void SceneStream::Close(void) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    running_.store(false);
+  }
+  space_.notify_all();
+  if (reader_.joinable()) {
+    reader_.join();
+  }
+  if (listen_fd_ >= 0) {
+    close(listen_fd_);
+    unlink(socket_path_.c_str());
+    listen_fd_ = -1;
+    socket_path_.clear();
+  }
+  fd_ = -1;
+}
+
+void SceneStream::Apply(ConsoleCoordinate& cc) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::swap(front_, back_);
+  }
+  space_.notify_one();
+
+  for (const Update& update : front_.updates) {
+    const auto vertex_begin = front_.vertices.begin() + update.vertex_begin;
+    const auto found = shape_indices_.find(update.shape_id);
+    switch (update.op) {
+      case kAddShape: {
+        const auto edge_begin = front_.edges.begin() + update.edge_begin;
+        ConsoleCoordinate::ShapeType shape(
+            std::vector<DotType>(vertex_begin,
+                                 vertex_begin + update.vertex_count),
+            std::vector<LineIndicatorType>(edge_begin,
+                                           edge_begin + update.edge_count));
+        if (found != shape_indices_.end()) {
+          cc.GetShapeAt(found->second) = std::move(shape);
+          cc.UpdateBoundingRadius(found->second);
+        } else {
+          shape_indices_[update.shape_id] = cc.GetShapeCount();
+          cc.AddShpae(std::move(shape));
+        }
+        break;
+      }
+      case kRemoveShape: {
+        if (found == shape_indices_.end()) {
+          break;
+        }
+        const size_t index = found->second;
+        cc.DeleteShapeAt(index);
+        shape_indices_.erase(found);
+        for (auto& entry : shape_indices_) {
+          if (entry.second > index) {
+            --entry.second;
+          }
+        }
+        break;
+      }
+      case kPatchVertices: {
+        if (found == shape_indices_.end()) {
+          break;
+        }
+        auto& shape = cc.GetShapeAt(found->second);
+        if (update.first + update.vertex_count <= shape.GetDotCount()) {
+          shape.SetVertices(update.first, &*vertex_begin, update.vertex_count);
+          cc.UpdateBoundingRadius(found->second);
+        }
+        break;
+      }
+      case kSetRotation:
+        rotation_ = *vertex_begin;
+        break;
+    }
+  }
+  front_.Clear();
+}
+
+void SceneStream::Read(void) {
+  if (listen_fd_ < 0) {
+    ReadConnection(fd_);
+    return;
+  }
+  while (running_.load(std::memory_order_relaxed)) {
+    if (!WaitReadable(listen_fd_)) {
+      continue;
+    }
+    const int client = accept(listen_fd_, nullptr, nullptr);
+    if (client < 0) {
+      continue;
+    }
+    ReadConnection(client);
+    close(client);
+  }
+}
+
+bool SceneStream::ReadConnection(int fd) {
+  staging_.Clear();
+  input_.clear();
+  while (running_.load(std::memory_order_relaxed)) {
+    if (!WaitReadable(fd)) {
+      continue;
+    }
+    const size_t old_size = input_.size();
+    input_.resize(old_size + kReadSize);
+    const ssize_t n = read(fd, input_.data() + old_size, kReadSize);
+    input_.resize(old_size + (n > 0 ? n : 0));
+    if (n < 0 && (errno == EINTR || errno == EAGAIN)) {
+      continue;
+    }
+    if (n <= 0) {
+      return true;
+    }
+
+    // Parse every message that has fully arrived; a partial one stays in
+    // input_ for the next read.
+    size_t offset = 0;
+    while (input_.size() - offset >= kHeaderSize) {
+      const uint8_t op = static_cast<uint8_t>(input_[offset]);
+      const uint32_t size = ReadU32(input_.data() + offset + 4);
+      if (size > kMaxPayloadSize) {
+        return false;
+      }
+      if (input_.size() - offset - kHeaderSize < size) {
+        break;
+      }
+      if (!ParseMessage(op, input_.data() + offset + kHeaderSize, size)) {
+        return false;
+      }
+      offset += kHeaderSize + size;
+    }
+    input_.erase(input_.begin(), input_.begin() + offset);
+    if (!staging_.updates.empty()) {
+      HandOver();
+    }
+  }
+  return true;
+}
+
+bool SceneStream::ParseMessage(uint8_t op, const char* payload, size_t size) {
+  Update update = {};
+  update.op = static_cast<Op>(op);
+  update.vertex_begin = staging_.vertices.size();
+  update.edge_begin = staging_.edges.size();
+  switch (op) {
+    case kAddShape: {
+      if (size < 12) {
+        return false;
+      }
+      update.shape_id = ReadU32(payload);
+      const uint32_t vertex_count = ReadU32(payload + 4);
+      const uint32_t edge_count = ReadU32(payload + 8);
+      if (size != 12 + 12 * static_cast<uint64_t>(vertex_count) +
+                      8 * static_cast<uint64_t>(edge_count)) {
+        return false;
+      }
+      AppendPositions(payload + 12, vertex_count);
+      const char* edges = payload + 12 + 12 * static_cast<size_t>(vertex_count);
+      for (uint32_t i = 0; i < edge_count; ++i) {
+        const uint32_t first = ReadU32(edges + 8 * i);
+        const uint32_t second = ReadU32(edges + 8 * i + 4);
+        if (first >= vertex_count || second >= vertex_count) {
+          staging_.vertices.resize(update.vertex_begin);
+          staging_.edges.resize(update.edge_begin);
+          return false;
+        }
+        staging_.edges.emplace_back(first, second);
+      }
+      update.vertex_count = vertex_count;
+      update.edge_count = edge_count;
+      break;
+    }
+    case kRemoveShape:
+      if (size != 4) {
+        return false;
+      }
+      update.shape_id = ReadU32(payload);
+      break;
+    case kPatchVertices:
+      if (size < 8 || (size - 8) % 12 != 0) {
+        return false;
+      }
+      update.shape_id = ReadU32(payload);
+      update.first = ReadU32(payload + 4);
+      update.vertex_count = (size - 8) / 12;
+      AppendPositions(payload + 8, update.vertex_count);
+      break;
+    case kSetRotation:
+      if (size != 12) {
+        return false;
+      }
+      update.vertex_count = 1;
+      AppendPositions(payload, 1);
+      break;
+    default:
+      return false;
+  }
+  staging_.updates.push_back(update);
+  return true;
+}
+
+void SceneStream::AppendPositions(const char* data, size_t count) {
+  for (size_t i = 0; i < count; ++i) {
+    float position[3];
+    std::memcpy(position, data + 12 * i, sizeof(position));
+    staging_.vertices.emplace_back(position[0], position[1], position[2]);
+  }
+}
+
+void SceneStream::HandOver(void) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  space_.wait(lock, [this] {
+    return !running_.load(std::memory_order_relaxed) ||
+           back_.GetByteSize() < kMaxPendingBytes;
+  });
+  if (back_.updates.empty()) {
+    // The common case when the renderer keeps up: no copy at all.
+    std::swap(back_, staging_);
+  } else {
+    const size_t vertex_offset = back_.vertices.size();
+    const size_t edge_offset = back_.edges.size();
+    for (Update update : staging_.updates) {
+      update.vertex_begin += vertex_offset;
+      update.edge_begin += edge_offset;
+      back_.updates.push_back(update);
+    }
+    back_.vertices.insert(back_.vertices.end(), staging_.vertices.begin(),
+                          staging_.vertices.end());
+    back_.edges.insert(back_.edges.end(), staging_.edges.begin(),
+                       staging_.edges.end());
+  }
+  staging_.Clear();
+}
+
+}  // namespace lotate_polyhedron
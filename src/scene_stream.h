@@ -0,0 +1,146 @@
+#ifndef LOTATE_POLYHEDRON_SCENE_STREAM_H_
+#define LOTATE_POLYHEDRON_SCENE_STREAM_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "console_coordinate.h"
+
+namespace lotate_polyhedron {
+
+// Receives scene updates from another process over stdin or a Unix socket.
+//
+// Every message is an 8 byte header followed by its payload, all fields
+// little endian:
+//   u8 op, u8[3] reserved, u32 payload size in bytes
+//   kAddShape       u32 id, u32 vertex count n, u32 edge count m,
+//                   f32[3 * n] positions, u32[2 * m] vertex index pairs
+//                   (replaces the shape if id is already in use)
+//   kRemoveShape    u32 id
+//   kPatchVertices  u32 id, u32 first vertex, f32[3 * k] positions
+//                   (k follows from the payload size)
+//   kSetRotation    f32 x, f32 y, f32 z; per-frame rotation of the scene
+// A malformed message ends the connection.
+//
+// A reader thread parses messages into a back batch while the renderer
+// draws; Apply() swaps it with the front batch under a short lock and
+// applies it between frames, so parsing and I/O never stall a frame. If
+// the renderer falls behind, the reader stops reading once the back batch
+// holds kMaxPendingBytes, pushing back on the sender instead of growing.
+class SceneStream {
+ public:
+  using FloatType = ConsoleCoordinate::FloatType;
+  using DotType = ConsoleCoordinate::DotType;
+  using LineIndicatorType = ConsoleCoordinate::LineIndicatorType;
+
+  enum Op : uint8_t {
+    kAddShape = 1,
+    kRemoveShape = 2,
+    kPatchVertices = 3,
+    kSetRotation = 4,
+  };
+
+  constexpr static size_t kHeaderSize = 8;
+  constexpr static size_t kMaxPayloadSize = 1 << 28;
+  constexpr static size_t kMaxPendingBytes = 64 << 20;
+
+ public:
+  explicit SceneStream(void);
+
+  SceneStream(const SceneStream&) = delete;
+  SceneStream& operator=(const SceneStream&) = delete;
+
+  ~SceneStream(void) { Close(); }
+
+ public:
+  // Reads messages from fd, e.g. STDIN_FILENO, until it reaches end of file.
+  bool Open(int fd);
+
+  // Listens on a Unix socket at path and serves one client at a time.
+  // Returns false if the socket could not be created.
+  bool Listen(const std::string& path);
+
+  void Close(void);
+
+  // Applies everything received since the last call. Call between frames on
+  // the thread that renders cc.
+  void Apply(ConsoleCoordinate& cc);
+
+  // Rotation last set by kSetRotation, zero until then.
+  inline const DotType& GetRotation(void) const { return rotation_; }
+
+ private:
+  struct Update {
+    Op op;
+    uint32_t shape_id;
+    uint32_t first;
+    // Ranges into Batch::vertices and Batch::edges.
+    size_t vertex_begin;
+    size_t vertex_count;
+    size_t edge_begin;
+    size_t edge_count;
+  };
+
+  struct Batch {
+    std::vector<Update> updates;
+    std::vector<DotType> vertices;
+    std::vector<LineIndicatorType> edges;
+
+    inline size_t GetByteSize(void) const {
+      return vertices.size() * sizeof(DotType) +
+             edges.size() * sizeof(LineIndicatorType);
+    }
+
+    inline void Clear(void) {
+      updates.clear();
+      vertices.clear();
+      edges.clear();
+    }
+  };
+
+ private:
+  void Read(void);
+
+  // Reads from fd until end of file, an error, a malformed message or
+  // Close(). Returns false on a malformed message.
+  bool ReadConnection(int fd);
+
+  // Parses one message into the staging batch; false if it is malformed.
+  bool ParseMessage(uint8_t op, const char* payload, size_t size);
+
+  void AppendPositions(const char* data, size_t count);
+
+  // Moves the parsed messages over to the back batch for the next Apply().
+  void HandOver(void);
+
+ private:
+  int fd_;
+  int listen_fd_;
+  std::string socket_path_;
+  std::atomic<bool> running_;
+  std::thread reader_;
+
+  // Reader thread only: messages parsed since the last hand-over, and
+  // bytes of a message that has not fully arrived.
+  Batch staging_;
+  std::vector<char> input_;
+
+  std::mutex mutex_;
+  std::condition_variable space_;
+  Batch back_;
+  // Render thread only.
+  Batch front_;
+
+  std::unordered_map<uint32_t, size_t> shape_indices_;
+  DotType rotation_;
+};
+
+}  // namespace lotate_polyhedron
+
+#endif
@@ -10,6 +10,19 @@
 
 namespace lotate_polyhedron {
 
+// Result of LineIterator::operator->. Holds the line by value so member
+// access needs no heap allocation.
+template <typename LineType>
+class LinePointer {
+ public:
+  explicit LinePointer(LineType&& line) : line_(std::move(line)) {}
+
+  inline const LineType* operator->(void) const { return &line_; }
+
+ private:
+  LineType line_;
+};
+
 template <typename FloatType, typename IteratorType>
 class LineIterator {
  private:
@@ -27,7 +40,7 @@ class LineIterator {
   virtual bool operator!=(const IteratorType& li) const = 0;
 
   virtual LineType operator*(void) const = 0;
-  virtual std::unique_ptr<LineType> operator->(void) const = 0;
+  virtual LinePointer<LineType> operator->(void) const = 0;
 };
 
 template <typename FloatType, typename IteratorType>
@@ -42,6 +55,9 @@ class Shape {
   Shape(const Shape& shape) {}
   Shape(Shape&& shape) {}
 
+  Shape& operator=(const Shape& shape) { return *this; }
+  Shape& operator=(Shape&& shape) { return *this; }
+
  public:
   virtual IteratorType begin(void) const = 0;
   virtual IteratorType end(void) const = 0;
@@ -1,11 +1,18 @@
 #ifndef LOTATEPOLYHEDRON_SHAPE_USING_EB_HPP_
 #define LOTATEPOLYHEDRON_SHAPE_USING_EB_HPP_
 
+#include <algorithm>
+#include <array>
 #include <cstdint>
+#include <limits>
 #include <memory>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "dot.hpp"
+#include "dot_kernels.h"
 #include "line.hpp"
 #include "shape.hpp"
 
@@ -63,10 +70,10 @@ class BELineIterator
                     vertices_[line_indices.second]);
   }
 
-  inline std::unique_ptr<LineType> operator->(void) const override {
+  inline LinePointer<LineType> operator->(void) const override {
     const auto& line_indices = line_elements_[line_idx_];
-    return std::make_unique<LineType>(vertices_[line_indices.first],
-                                      vertices_[line_indices.second]);
+    return LinePointer<LineType>(LineType(vertices_[line_indices.first],
+                                          vertices_[line_indices.second]));
   }
 
  private:
@@ -85,8 +92,22 @@ class ElementBufferLineShape
   using LineType = Line<FloatType>;
   using LineIndicatorType = std::pair<size_t, size_t>;
   using LineIndicatorVectorType = std::vector<LineIndicatorType>;
+  using FaceType = std::array<size_t, 3>;
+  using FaceVectorType = std::vector<FaceType>;
+
+  constexpr static uint32_t kNoFace = std::numeric_limits<uint32_t>::max();
+
+  // A coarser copy of the edge list. Levels only reference vertices of the
+  // shape itself, so rotating the shape keeps every level in place.
+  struct LevelOfDetail {
+    LineIndicatorVectorType line_elements;
+    // Upper bound of the distance between any original vertex and the
+    // vertex standing in for it, in scene units.
+    FloatType error;
+  };
 
   constexpr static FloatType kPi{3.14159265359};
+  constexpr static FloatType kSqrt3{1.73205080757};
 
  public:
   explicit ElementBufferLineShape(void) = delete;
@@ -103,11 +124,36 @@ class ElementBufferLineShape
         line_elements_(std::move(line_elements)) {}
 
   explicit ElementBufferLineShape(const ElementBufferLineShape& ebs)
-      : vertices_(ebs.vertices_), line_elements_(ebs.line_elements_) {}
+      : vertices_(ebs.vertices_),
+        line_elements_(ebs.line_elements_),
+        levels_(ebs.levels_),
+        faces_(ebs.faces_),
+        edge_faces_(ebs.edge_faces_) {}
 
   explicit ElementBufferLineShape(ElementBufferLineShape&& ebs)
       : vertices_(std::move(ebs.vertices_)),
-        line_elements_(std::move(ebs.line_elements_)) {}
+        line_elements_(std::move(ebs.line_elements_)),
+        levels_(std::move(ebs.levels_)),
+        faces_(std::move(ebs.faces_)),
+        edge_faces_(std::move(ebs.edge_faces_)) {}
+
+  ElementBufferLineShape& operator=(const ElementBufferLineShape& ebs) {
+    vertices_ = ebs.vertices_;
+    line_elements_ = ebs.line_elements_;
+    levels_ = ebs.levels_;
+    faces_ = ebs.faces_;
+    edge_faces_ = ebs.edge_faces_;
+    return *this;
+  }
+
+  ElementBufferLineShape& operator=(ElementBufferLineShape&& ebs) {
+    vertices_ = std::move(ebs.vertices_);
+    line_elements_ = std::move(ebs.line_elements_);
+    levels_ = std::move(ebs.levels_);
+    faces_ = std::move(ebs.faces_);
+    edge_faces_ = std::move(ebs.edge_faces_);
+    return *this;
+  }
 
  public:
   inline BELineIterator<FloatType> begin(void) const override {
@@ -125,27 +171,240 @@ class ElementBufferLineShape
     return line_elements_.size();
   }
 
+  inline const VertexVectorType& GetVertices(void) const { return vertices_; }
+
+  inline const LineIndicatorVectorType& GetLineElements(void) const {
+    return line_elements_;
+  }
+
+  // Overwrites vertices [first, first + count). Levels of detail are
+  // dropped, as their error bounds no longer hold for the moved vertices.
+  inline void SetVertices(size_t first, const DotType* dots, size_t count) {
+    std::copy(dots, dots + count, vertices_.begin() + first);
+    levels_.clear();
+  }
+
+  // Sets the triangles of a closed surface, wound consistently, and links
+  // every edge to the (up to two) faces that share it. Face sides without a
+  // matching edge are skipped; an edge shared by more than two faces keeps
+  // the first two.
+  void SetFaces(FaceVectorType faces) {
+    faces_ = std::move(faces);
+    edge_faces_.assign(line_elements_.size(), {kNoFace, kNoFace});
+    std::unordered_map<uint64_t, size_t> edge_indices(line_elements_.size());
+    auto key = [](size_t a, size_t b) {
+      return (static_cast<uint64_t>(std::min(a, b)) << 32) | std::max(a, b);
+    };
+    for (size_t i = 0; i < line_elements_.size(); ++i) {
+      edge_indices.emplace(
+          key(line_elements_[i].first, line_elements_[i].second), i);
+    }
+    for (size_t f = 0; f < faces_.size(); ++f) {
+      for (int k = 0; k < 3; ++k) {
+        const auto found =
+            edge_indices.find(key(faces_[f][k], faces_[f][(k + 1) % 3]));
+        if (found == edge_indices.end()) {
+          continue;
+        }
+        auto& slots = edge_faces_[found->second];
+        if (slots[0] == kNoFace) {
+          slots[0] = static_cast<uint32_t>(f);
+        } else if (slots[1] == kNoFace) {
+          slots[1] = static_cast<uint32_t>(f);
+        }
+      }
+    }
+  }
+
+  inline bool HasFaces(void) const { return !faces_.empty(); }
+
+  inline const FaceVectorType& GetFaces(void) const { return faces_; }
+
+  // Appends the edges on the outline seen along view: edges between a face
+  // turned towards view and one turned away, plus edges with fewer than two
+  // faces, which cannot be culled. Needs SetFaces().
+  template <typename LineIndicatorContainer>
+  void ExtractSilhouette(const DotType& view,
+                         LineIndicatorContainer& silhouette) const {
+    ExtractSilhouette(vertices_.data(), view, silhouette);
+  }
+
+  // As above with the shape posed at vertices, one per stored vertex.
+  template <typename LineIndicatorContainer>
+  void ExtractSilhouette(const DotType* vertices, const DotType& view,
+                         LineIndicatorContainer& silhouette) const {
+    facing_.resize(faces_.size());
+    for (size_t f = 0; f < faces_.size(); ++f) {
+      const DotType& a = vertices[faces_[f][0]];
+      const DotType edge1 = vertices[faces_[f][1]] - a;
+      const DotType edge2 = vertices[faces_[f][2]] - a;
+      facing_[f] =
+          edge1.CrossProduct(edge2).DotProduct(view) > FloatType(0.0);
+    }
+    for (size_t i = 0; i < line_elements_.size(); ++i) {
+      const auto& slots = edge_faces_[i];
+      if (slots[1] == kNoFace || facing_[slots[0]] != facing_[slots[1]]) {
+        silhouette.push_back(line_elements_[i]);
+      }
+    }
+  }
+
+  // Level 0 is the full edge list; higher levels are coarser.
+  inline size_t GetLevelOfDetailCount(void) const {
+    return levels_.size() + 1;
+  }
+
+  inline const LineIndicatorVectorType& GetLineElements(size_t level) const {
+    return level == 0 ? line_elements_ : levels_[level - 1].line_elements;
+  }
+
+  inline FloatType GetLevelOfDetailError(size_t level) const {
+    return level == 0 ? FloatType(0.0) : levels_[level - 1].error;
+  }
+
+  // Returns the coarsest level whose error stays below |max_error|.
+  inline size_t SelectLevelOfDetail(const FloatType& max_error) const {
+    size_t level = 0;
+    while (level < levels_.size() && levels_[level].error < max_error) {
+      ++level;
+    }
+    return level;
+  }
+
+  // Builds up to |max_levels| coarser edge lists by greedy shortest edge
+  // collapse, each level removing about half of the edges of the previous
+  // one. A collapsed vertex merges into one of its own neighbours, so no new
+  // vertices are made and the levels stay valid under rotation.
+  void BuildLevelsOfDetail(size_t max_levels = 8) {
+    levels_.clear();
+    const size_t vertex_count = vertices_.size();
+    std::vector<size_t> representative(vertex_count);
+    std::vector<FloatType> error(vertex_count, FloatType(0.0));
+    std::vector<bool> touched(vertex_count);
+    std::vector<std::pair<FloatType, size_t>> order;
+    LineIndicatorVectorType edges(line_elements_);
+    FloatType level_error(0.0);
+    for (size_t level = 0; level < max_levels; ++level) {
+      order.clear();
+      for (size_t i = 0; i < edges.size(); ++i) {
+        order.emplace_back(GetCollapseDistance(edges[i]), i);
+      }
+      std::sort(order.begin(), order.end(),
+                [](const std::pair<FloatType, size_t>& a,
+                   const std::pair<FloatType, size_t>& b) {
+                  return a.first < b.first;
+                });
+      for (size_t i = 0; i < vertex_count; ++i) {
+        representative[i] = i;
+      }
+      std::fill(touched.begin(), touched.end(), false);
+
+      // Collapse disjoint edges only, so every edge of this level is remapped
+      // by a single representative lookup.
+      const size_t target = edges.size() / 2;
+      size_t collapsed = 0;
+      for (const auto& entry : order) {
+        if (collapsed >= target) {
+          break;
+        }
+        size_t keep = edges[entry.second].first;
+        size_t drop = edges[entry.second].second;
+        if (touched[keep] || touched[drop]) {
+          continue;
+        }
+        touched[keep] = touched[drop] = true;
+        if (error[drop] > error[keep]) {
+          std::swap(keep, drop);
+        }
+        representative[drop] = keep;
+        error[keep] = std::max(error[keep], error[drop] + entry.first);
+        level_error = std::max(level_error, error[keep]);
+        ++collapsed;
+      }
+      if (collapsed == 0) {
+        break;
+      }
+
+      for (auto& edge : edges) {
+        edge.first = representative[edge.first];
+        edge.second = representative[edge.second];
+        if (edge.first > edge.second) {
+          std::swap(edge.first, edge.second);
+        }
+      }
+      edges.erase(std::remove_if(edges.begin(), edges.end(),
+                                 [](const LineIndicatorType& edge) {
+                                   return edge.first == edge.second;
+                                 }),
+                  edges.end());
+      std::sort(edges.begin(), edges.end());
+      edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+      levels_.push_back(LevelOfDetail{edges, level_error});
+    }
+  }
+
   void LotateAroundXAxis(const FloatType& angle) override {
+    // Fixed-point shapes go through the batch kernels once enabled.
+    if constexpr (std::is_same<FloatType, DotKernels::FloatType>::value) {
+      if (DotKernels::IsEnabled()) {
+        DotKernels::LotateAroundXAxis(vertices_.data(), vertices_.size(),
+                                      angle);
+        return;
+      }
+    }
     for (size_t i = 0; i < vertices_.size(); ++i) {
       vertices_[i].LotateAroundXAxisSelf(angle);
     }
   }
 
   void LotateAroundYAxis(const FloatType& angle) override {
+    if constexpr (std::is_same<FloatType, DotKernels::FloatType>::value) {
+      if (DotKernels::IsEnabled()) {
+        DotKernels::LotateAroundYAxis(vertices_.data(), vertices_.size(),
+                                      angle);
+        return;
+      }
+    }
     for (size_t i = 0; i < vertices_.size(); ++i) {
       vertices_[i].LotateAroundYAxisSelf(angle);
     }
   }
 
   void LotateAroundZAxis(const FloatType& angle) override {
+    if constexpr (std::is_same<FloatType, DotKernels::FloatType>::value) {
+      if (DotKernels::IsEnabled()) {
+        DotKernels::LotateAroundZAxis(vertices_.data(), vertices_.size(),
+                                      angle);
+        return;
+      }
+    }
     for (size_t i = 0; i < vertices_.size(); ++i) {
       vertices_[i].LotateAroundZAxisSelf(angle);
     }
   }
 
+ private:
+  // Euclidean length bounded through the largest axis difference, which
+  // keeps the bound independent of later rotations.
+  inline FloatType GetCollapseDistance(const LineIndicatorType& edge) const {
+    const DotType& dot1 = vertices_[edge.first];
+    const DotType& dot2 = vertices_[edge.second];
+    const FloatType dx = abs(dot1.x - dot2.x);
+    const FloatType dy = abs(dot1.y - dot2.y);
+    const FloatType dz = abs(dot1.z - dot2.z);
+    return std::max(dx, std::max(dy, dz)) * kSqrt3;
+  }
+
  private:
   VertexVectorType vertices_;
   LineIndicatorVectorType line_elements_;
+  std::vector<LevelOfDetail> levels_;
+  FaceVectorType faces_;
+  // Faces on either side of each line element, kNoFace if missing.
+  std::vector<std::array<uint32_t, 2>> edge_faces_;
+  // Per-face scratch for ExtractSilhouette(), kept to avoid reallocating;
+  // one shape must not extract silhouettes on two threads at once.
+  mutable std::vector<uint8_t> facing_;
 };
 
 }  // namespace lotate_polyhedron
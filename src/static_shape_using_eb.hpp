@@ -0,0 +1,147 @@
+#ifndef LOTATEPOLYHEDRON_STATIC_SHAPE_USING_EB_HPP_
+#define LOTATEPOLYHEDRON_STATIC_SHAPE_USING_EB_HPP_
+
+#include <array>
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+#include "dot.hpp"
+#include "line.hpp"
+
+namespace lotate_polyhedron {
+
+// ElementBufferLineShape for meshes whose size is known at compile time,
+// such as the cube, the pyramid or overlay gizmos. Vertices and edges live
+// in std::arrays inside the object, so it can be built from constexpr data
+// and copied without touching the heap, and every per-vertex and per-edge
+// loop is unrolled. There is no Shape base class; Coordinate stores these
+// by exact type, so nothing is dispatched at run time.
+template <typename __FloatType, size_t kVertexCount, size_t kLineCount>
+class StaticElementBufferShape {
+ public:
+  using FloatType = __FloatType;
+  using DotType = Dot<FloatType>;
+  using LineType = Line<FloatType>;
+  using LineIndicatorType = std::pair<size_t, size_t>;
+  using VertexArrayType = std::array<DotType, kVertexCount>;
+  using LineIndicatorArrayType = std::array<LineIndicatorType, kLineCount>;
+
+ public:
+  explicit StaticElementBufferShape(void) = delete;
+
+  constexpr explicit StaticElementBufferShape(
+      const VertexArrayType& vertices,
+      const LineIndicatorArrayType& line_elements)
+      : vertices_(vertices), line_elements_(line_elements) {}
+
+  constexpr StaticElementBufferShape(const StaticElementBufferShape& sebs)
+      : vertices_(sebs.vertices_), line_elements_(sebs.line_elements_) {}
+
+  StaticElementBufferShape& operator=(const StaticElementBufferShape& sebs) {
+    Unroll<kVertexCount>(
+        [this, &sebs](auto i) { vertices_[i] = sebs.vertices_[i]; });
+    line_elements_ = sebs.line_elements_;
+    return *this;
+  }
+
+ public:
+  constexpr inline size_t GetDotCount(void) const { return kVertexCount; }
+  constexpr inline size_t GetLineCount(void) const { return kLineCount; }
+
+  constexpr inline const VertexArrayType& GetVertices(void) const {
+    return vertices_;
+  }
+
+  constexpr inline const LineIndicatorArrayType& GetLineElements(void) const {
+    return line_elements_;
+  }
+
+  // The rotations compute sin and cos once and round exactly like
+  // Dot::LotateAround?AxisSelf(), so results match a dynamic shape.
+  void LotateAroundXAxis(FloatType angle) {
+    if (abs(angle) >= DotType::kPi) {
+      angle /= DotType::kPi;
+    }
+    const FloatType c = cos(angle);
+    const FloatType s = sin(angle);
+    Unroll<kVertexCount>([this, &c, &s](auto i) {
+      DotType& v = vertices_[i];
+      const FloatType new_y = v.y * c - v.z * s;
+      const FloatType new_z = v.y * s + v.z * c;
+      v.y = new_y;
+      v.z = new_z;
+    });
+  }
+
+  void LotateAroundYAxis(FloatType angle) {
+    if (abs(angle) >= DotType::kPi) {
+      angle /= DotType::kPi;
+    }
+    const FloatType c = cos(angle);
+    const FloatType s = sin(angle);
+    Unroll<kVertexCount>([this, &c, &s](auto i) {
+      DotType& v = vertices_[i];
+      const FloatType new_x = v.x * c + v.z * s;
+      const FloatType new_z = -v.x * s + v.z * c;
+      v.x = new_x;
+      v.z = new_z;
+    });
+  }
+
+  void LotateAroundZAxis(FloatType angle) {
+    if (abs(angle) >= DotType::kPi) {
+      angle /= DotType::kPi;
+    }
+    const FloatType c = cos(angle);
+    const FloatType s = sin(angle);
+    Unroll<kVertexCount>([this, &c, &s](auto i) {
+      DotType& v = vertices_[i];
+      const FloatType new_x = v.x * c - v.y * s;
+      const FloatType new_y = v.x * s + v.y * c;
+      v.x = new_x;
+      v.y = new_y;
+    });
+  }
+
+  // Returns {function(vertex) for every vertex}, e.g. to project them.
+  template <typename Function>
+  constexpr VertexArrayType Map(Function&& function) const {
+    return MapImpl(function, std::make_index_sequence<kVertexCount>());
+  }
+
+  // Calls function(line_element) for every edge.
+  template <typename Function>
+  constexpr void ForEachLineElement(Function&& function) const {
+    Unroll<kLineCount>(
+        [this, &function](auto i) { function(line_elements_[i]); });
+  }
+
+ private:
+  // Calls function(std::integral_constant<size_t, i>()) for i in
+  // [0, kCount), expanded at compile time.
+  template <size_t kCount, typename Function>
+  constexpr static void Unroll(Function&& function) {
+    UnrollImpl(function, std::make_index_sequence<kCount>());
+  }
+
+  template <typename Function, size_t... kIndices>
+  constexpr static void UnrollImpl(Function& function,
+                                   std::index_sequence<kIndices...>) {
+    (function(std::integral_constant<size_t, kIndices>()), ...);
+  }
+
+  template <typename Function, size_t... kIndices>
+  constexpr VertexArrayType MapImpl(Function& function,
+                                    std::index_sequence<kIndices...>) const {
+    return VertexArrayType{{function(vertices_[kIndices])...}};
+  }
+
+ private:
+  VertexArrayType vertices_;
+  LineIndicatorArrayType line_elements_;
+};
+
+}  // namespace lotate_polyhedron
+
+#endif
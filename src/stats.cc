@@ -0,0 +1,123 @@
+#include "stats.h"
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <iostream>
+
+#include "console_buffer.h"
+
+namespace lotate_polyhedron {
+
+namespace {
+
+constexpr const char* kCounterNames[] = {
+    "vertices_transformed",
+    "edges_drawn",
+    "cells_written",
+    "bytes_flushed",
+    "arena_blocks_allocated",
+};
+
+constexpr const char* kTimerNames[] = {
+    "transform_ns",
+    "rasterize_ns",
+    "flush_ns",
+    "record_ns",
+};
+
+constexpr Stats::Stage kCounterStages[] = {
+    Stats::kProduceStage,
+    Stats::kProduceStage,
+    Stats::kProduceStage,
+    Stats::kPresentStage,
+    Stats::kProduceStage,
+};
+
+constexpr Stats::Stage kTimerStages[] = {
+    Stats::kProduceStage,
+    Stats::kProduceStage,
+    Stats::kPresentStage,
+    Stats::kProduceStage,
+};
+
+}  // namespace
+
+std::atomic<uint64_t> Stats::counters_[kCounterCount] = {};
+std::atomic<uint64_t> Stats::timers_[kTimerCount] = {};
+std::atomic<uint64_t> Stats::last_counters_[kCounterCount] = {};
+std::atomic<uint64_t> Stats::last_timers_[kTimerCount] = {};
+uint64_t Stats::frame_count_ = 0;
+
+void Stats::EndFrame(Stage stage) {
+  for (int i = 0; i < kCounterCount; ++i) {
+    if (kCounterStages[i] & stage) {
+      last_counters_[i].store(
+          counters_[i].exchange(0, std::memory_order_relaxed),
+          std::memory_order_relaxed);
+    }
+  }
+  for (int i = 0; i < kTimerCount; ++i) {
+    if (kTimerStages[i] & stage) {
+      last_timers_[i].store(timers_[i].exchange(0, std::memory_order_relaxed),
+                            std::memory_order_relaxed);
+    }
+  }
+  if (stage & kProduceStage) {
+    ++frame_count_;
+  }
+}
+
+void Stats::DrawOverlay(ConsoleBuffer& cb, size_t x, size_t y) {
+  // Formatted on the stack so the overlay does not allocate every frame.
+  char line[64];
+  for (int i = 0; i < kCounterCount && y < cb.GetConsoleHeight(); ++i, ++y) {
+    const uint64_t value = last_counters_[i].load(std::memory_order_relaxed);
+    snprintf(line, sizeof(line), "%s %llu", kCounterNames[i],
+             static_cast<unsigned long long>(value));
+    cb.PrintAt(x, y, line);
+  }
+  for (int i = 0; i < kTimerCount && y < cb.GetConsoleHeight(); ++i, ++y) {
+    const uint64_t value = last_timers_[i].load(std::memory_order_relaxed);
+    snprintf(line, sizeof(line), "%s %llu", kTimerNames[i],
+             static_cast<unsigned long long>(value));
+    cb.PrintAt(x, y, line);
+  }
+}
+
+void Stats::DumpCsvHeader(std::ostream& os) {
+  os << "frame";
+  for (const char* name : kCounterNames) {
+    os << ',' << name;
+  }
+  for (const char* name : kTimerNames) {
+    os << ',' << name;
+  }
+  os << '\n';
+}
+
+void Stats::DumpCsv(std::ostream& os) {
+  os << frame_count_;
+  for (const auto& value : last_counters_) {
+    os << ',' << value.load(std::memory_order_relaxed);
+  }
+  for (const auto& value : last_timers_) {
+    os << ',' << value.load(std::memory_order_relaxed);
+  }
+  os << '\n';
+}
+
+void Stats::DumpJson(std::ostream& os) {
+  os << "{\"frame\":" << frame_count_;
+  for (int i = 0; i < kCounterCount; ++i) {
+    os << ",\"" << kCounterNames[i]
+       << "\":" << last_counters_[i].load(std::memory_order_relaxed);
+  }
+  for (int i = 0; i < kTimerCount; ++i) {
+    os << ",\"" << kTimerNames[i]
+       << "\":" << last_timers_[i].load(std::memory_order_relaxed);
+  }
+  os << "}\n";
+}
+
+}  // namespace lotate_polyhedron
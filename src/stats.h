@@ -0,0 +1,130 @@
+#ifndef LOTATE_POLYHEDRON_STATS_H_
+#define LOTATE_POLYHEDRON_STATS_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+
+namespace lotate_polyhedron {
+
+class ConsoleBuffer;
+
+// Hot-path counters and stage timers.
+//
+// Instrumentation points use the LOTATE_POLYHEDRON_STATS_* macros below,
+// which compile to nothing unless LOTATE_POLYHEDRON_STATS is defined
+// (`make STATS=1`). Counters are relaxed atomics so the pipelined renderer
+// can update them from several threads. EndFrame() moves the running values
+// into the last-frame snapshot read by the overlay and the dumps. The
+// pipelined renderer ends the producer's and the presenter's frames
+// separately, so neither cuts the other's numbers short; the frame count
+// follows the producer.
+class Stats {
+ public:
+#ifdef LOTATE_POLYHEDRON_STATS
+  constexpr static bool kEnabled = true;
+#else
+  constexpr static bool kEnabled = false;
+#endif
+
+  enum Counter {
+    kVerticesTransformed,
+    kEdgesDrawn,
+    kCellsWritten,
+    kBytesFlushed,
+    kArenaBlocksAllocated,
+    kCounterCount,
+  };
+
+  enum Timer {
+    kTransformTime,
+    kRasterizeTime,
+    kFlushTime,
+    kRecordTime,
+    kTimerCount,
+  };
+
+  // Flushing belongs to the present stage, everything else to produce.
+  enum Stage : uint8_t {
+    kProduceStage = 1,
+    kPresentStage = 2,
+    kAllStages = kProduceStage | kPresentStage,
+  };
+
+ public:
+  inline static void Add(Counter counter, uint64_t n) {
+    counters_[counter].fetch_add(n, std::memory_order_relaxed);
+  }
+
+  inline static void AddTime(Timer timer, uint64_t ns) {
+    timers_[timer].fetch_add(ns, std::memory_order_relaxed);
+  }
+
+  inline static uint64_t GetLastFrame(Counter counter) {
+    return last_counters_[counter].load(std::memory_order_relaxed);
+  }
+
+  inline static uint64_t GetLastFrameTime(Timer timer) {
+    return last_timers_[timer].load(std::memory_order_relaxed);
+  }
+
+  inline static uint64_t GetFrameCount(void) { return frame_count_; }
+
+  static void EndFrame(Stage stage = kAllStages);
+
+  // Prints the last frame's numbers into the buffer at (x, y).
+  static void DrawOverlay(ConsoleBuffer& cb, size_t x = 0, size_t y = 0);
+
+  static void DumpCsvHeader(std::ostream& os);
+
+  // One row (CSV) or one object per line (JSON) for the last frame.
+  static void DumpCsv(std::ostream& os);
+
+  static void DumpJson(std::ostream& os);
+
+ private:
+  static std::atomic<uint64_t> counters_[kCounterCount];
+  static std::atomic<uint64_t> timers_[kTimerCount];
+  static std::atomic<uint64_t> last_counters_[kCounterCount];
+  static std::atomic<uint64_t> last_timers_[kTimerCount];
+  static uint64_t frame_count_;
+};
+
+class ScopedStatTimer {
+ public:
+  explicit ScopedStatTimer(Stats::Timer timer)
+      : timer_(timer), start_(std::chrono::steady_clock::now()) {}
+
+  ScopedStatTimer(const ScopedStatTimer&) = delete;
+  ScopedStatTimer& operator=(const ScopedStatTimer&) = delete;
+
+  ~ScopedStatTimer(void) {
+    const auto elapsed = std::chrono::steady_clock::now() - start_;
+    Stats::AddTime(
+        timer_,
+        std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+  }
+
+ private:
+  Stats::Timer timer_;
+  std::chrono::steady_clock::time_point start_;
+};
+
+}  // namespace lotate_polyhedron
+
+#ifdef LOTATE_POLYHEDRON_STATS
+#define LOTATE_POLYHEDRON_STATS_CONCAT_INNER(a, b) a##b
+#define LOTATE_POLYHEDRON_STATS_CONCAT(a, b) \
+  LOTATE_POLYHEDRON_STATS_CONCAT_INNER(a, b)
+#define LOTATE_POLYHEDRON_STATS_COUNT(counter, n) \
+  ::lotate_polyhedron::Stats::Add(::lotate_polyhedron::Stats::counter, (n))
+#define LOTATE_POLYHEDRON_STATS_TIMER(timer)                              \
+  ::lotate_polyhedron::ScopedStatTimer LOTATE_POLYHEDRON_STATS_CONCAT(    \
+      stat_timer_, __LINE__)(::lotate_polyhedron::Stats::timer)
+#else
+#define LOTATE_POLYHEDRON_STATS_COUNT(counter, n) ((void)sizeof(n))
+#define LOTATE_POLYHEDRON_STATS_TIMER(timer) ((void)0)
+#endif
+
+#endif
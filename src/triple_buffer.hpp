@@ -0,0 +1,61 @@
+#ifndef LOTATEPOLYHEDRON_TRIPLE_BUFFER_HPP_
+#define LOTATEPOLYHEDRON_TRIPLE_BUFFER_HPP_
+
+#include <atomic>
+#include <cstdint>
+
+namespace lotate_polyhedron {
+
+// Lock-free single producer / single consumer triple buffer.
+// The producer fills GetBackBuffer() and calls Publish(); the consumer calls
+// Consume() and reads GetFrontBuffer(). The middle slot is exchanged
+// atomically, so neither side ever waits and the consumer always sees the
+// latest published value (older unconsumed values are overwritten).
+template <typename T>
+class TripleBuffer {
+ private:
+  constexpr static uint8_t kIndexMask = 0x3;
+  constexpr static uint8_t kDirtyBit = 0x4;
+
+ public:
+  explicit TripleBuffer(void) : middle_(1), back_(0), front_(2) {}
+
+  TripleBuffer(const TripleBuffer&) = delete;
+  TripleBuffer& operator=(const TripleBuffer&) = delete;
+
+  inline T& GetBackBuffer(void) { return buffers_[back_]; }
+
+  inline const T& GetFrontBuffer(void) const { return buffers_[front_]; }
+
+  inline T& GetFrontBuffer(void) { return buffers_[front_]; }
+
+  // Producer side: hands the back buffer over and takes the middle one.
+  inline void Publish(void) {
+    back_ = middle_.exchange(back_ | kDirtyBit, std::memory_order_acq_rel) &
+            kIndexMask;
+  }
+
+  // Consumer side: whether Consume() would return true.
+  inline bool HasPublished(void) const {
+    return (middle_.load(std::memory_order_acquire) & kDirtyBit) != 0;
+  }
+
+  // Consumer side: returns false if nothing was published since last call.
+  inline bool Consume(void) {
+    if (!HasPublished()) {
+      return false;
+    }
+    front_ = middle_.exchange(front_, std::memory_order_acq_rel) & kIndexMask;
+    return true;
+  }
+
+ private:
+  T buffers_[3];
+  std::atomic<uint8_t> middle_;
+  uint8_t back_;
+  uint8_t front_;
+};
+
+}  // namespace lotate_polyhedron
+
+#endif
@@ -0,0 +1,121 @@
+#ifndef LOTATE_POLYHEDRON_VIEWPORT_H_
+#define LOTATE_POLYHEDRON_VIEWPORT_H_
+
+#include <algorithm>
+#include <cstddef>
+
+#include "dot.hpp"
+#include "fixed_point.hpp"
+
+namespace lotate_polyhedron {
+
+// Axis aligned rectangle of console cells; right and bottom are exclusive.
+struct ScreenRect {
+  size_t left = 0;
+  size_t top = 0;
+  size_t width = 0;
+  size_t height = 0;
+
+  inline size_t GetRight(void) const { return left + width; }
+  inline size_t GetBottom(void) const { return top + height; }
+};
+
+// A view of the scene drawn into a sub-rectangle of the console.
+// Project() maps an already-transformed scene dot to console cells, keeping
+// the depth towards the viewer in z for depth shading.
+class Viewport {
+ public:
+  using FloatType = FixedPoint<32>;
+  using DotType = Dot<FloatType>;
+
+  enum class Projection {
+    // Screen (x, y) = scene (x, y), depth z.
+    kFront,
+    // Looking down the y axis: screen (x, y) = scene (x, z), depth y.
+    kTop,
+    // Looking along the x axis: screen (x, y) = scene (z, y), depth x.
+    kSide,
+  };
+
+ private:
+  constexpr static int WidthPerHeightZoomFactor = 2;
+
+ public:
+  explicit Viewport(void) = delete;
+
+  explicit Viewport(const ScreenRect& rect, Projection projection,
+                    double zoom_factor)
+      : rect_(rect),
+        projection_(projection),
+        width_zoom_factor_(WidthPerHeightZoomFactor * zoom_factor),
+        height_zoom_factor_(zoom_factor) {
+    SetOriginCentor();
+  }
+
+ public:
+  inline const ScreenRect& GetRect(void) const { return rect_; }
+  inline Projection GetProjection(void) const { return projection_; }
+
+  inline void SetRect(const ScreenRect& rect) {
+    rect_ = rect;
+    SetOriginCentor();
+  }
+  inline void SetProjection(Projection projection) {
+    projection_ = projection;
+  }
+  inline void SetZoomFactor(double factor) {
+    width_zoom_factor_ = FloatType(WidthPerHeightZoomFactor * factor);
+    height_zoom_factor_ = FloatType(factor);
+  }
+
+  // Scene distance covered by one console cell along the denser axis.
+  inline FloatType GetCellSize(void) const {
+    return FloatType(1.0) / std::max(width_zoom_factor_, height_zoom_factor_);
+  }
+
+  // Scene axis the view looks along, i.e. the one Project() keeps as depth.
+  inline DotType GetViewDirection(void) const {
+    switch (projection_) {
+      case Projection::kTop:
+        return DotType(0, 1, 0);
+      case Projection::kSide:
+        return DotType(1, 0, 0);
+      case Projection::kFront:
+      default:
+        return DotType(0, 0, 1);
+    }
+  }
+
+  inline DotType Project(const DotType& dot) const {
+    switch (projection_) {
+      case Projection::kTop:
+        return DotType(dot.x * width_zoom_factor_ + origin_x_,
+                       dot.z * height_zoom_factor_ + origin_y_, dot.y);
+      case Projection::kSide:
+        return DotType(dot.z * width_zoom_factor_ + origin_x_,
+                       dot.y * height_zoom_factor_ + origin_y_, dot.x);
+      case Projection::kFront:
+      default:
+        return DotType(dot.x * width_zoom_factor_ + origin_x_,
+                       dot.y * height_zoom_factor_ + origin_y_, dot.z);
+    }
+  }
+
+ private:
+  inline void SetOriginCentor(void) {
+    origin_x_ = FloatType(static_cast<int64_t>(rect_.left + rect_.width / 2));
+    origin_y_ = FloatType(static_cast<int64_t>(rect_.top + rect_.height / 2));
+  }
+
+ private:
+  ScreenRect rect_;
+  Projection projection_;
+  FloatType width_zoom_factor_;
+  FloatType height_zoom_factor_;
+  FloatType origin_x_;
+  FloatType origin_y_;
+};
+
+}  // namespace lotate_polyhedron
+
+#endif
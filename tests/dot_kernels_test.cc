@@ -0,0 +1,141 @@
+// Checks that every DotKernels path gives exactly the results of the Dot
+// operations it replaces, so rasterized frames do not depend on the CPU or
+// on how FixedPoint rounds internally.
+
+#include <cstddef>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "dot.hpp"
+#include "dot_kernels.h"
+
+using namespace lotate_polyhedron;
+
+namespace {
+
+using FloatType = DotKernels::FloatType;
+using DotType = DotKernels::DotType;
+
+// Span lengths around the four-dot AVX2 blocks, including the scalar tail.
+constexpr size_t kCounts[] = {0, 1, 3, 4, 5, 8, 13, 1000};
+
+// Includes angles of at least pi, which Dot reduces.
+constexpr double kAngles[] = {0.0, 0.03, -0.7, 1.5707963267949,
+                              3.0, -3.2, 7.5, -100.0};
+
+std::vector<DotType> MakeRandomDots(std::mt19937_64& rng, size_t count) {
+  // Values up to 1e4 keep more random fraction bits than Q32.32 stores.
+  std::uniform_real_distribution<double> value(-1e4, 1e4);
+  std::vector<DotType> dots;
+  dots.reserve(count);
+  for (size_t i = 0; i < count; ++i) {
+    dots.emplace_back(value(rng), value(rng), value(rng));
+  }
+  return dots;
+}
+
+size_t CountMismatches(const std::vector<DotType>& actual,
+                       const std::vector<DotType>& expected) {
+  size_t mismatches = 0;
+  for (size_t i = 0; i < actual.size(); ++i) {
+    if (!(actual[i].x == expected[i].x && actual[i].y == expected[i].y &&
+          actual[i].z == expected[i].z)) {
+      ++mismatches;
+    }
+  }
+  return mismatches;
+}
+
+bool Report(const std::string& name, size_t mismatches) {
+  std::cout << (mismatches == 0 ? "PASS " : "FAIL ") << name;
+  if (mismatches != 0) {
+    std::cout << " (" << mismatches << " dots differ)";
+  }
+  std::cout << std::endl;
+  return mismatches == 0;
+}
+
+// Compares the kernels of the selected path with Dot.
+bool CheckKernels(const std::string& isa_name) {
+  std::mt19937_64 rng(12345);
+  bool passed = true;
+
+  struct Rotation {
+    const char* name;
+    void (*kernel)(DotType*, size_t, FloatType);
+    void (*reference)(DotType&, FloatType);
+  };
+  const Rotation rotations[] = {
+      {"x", DotKernels::LotateAroundXAxis,
+       [](DotType& dot, FloatType angle) { dot.LotateAroundXAxisSelf(angle); }},
+      {"y", DotKernels::LotateAroundYAxis,
+       [](DotType& dot, FloatType angle) { dot.LotateAroundYAxisSelf(angle); }},
+      {"z", DotKernels::LotateAroundZAxis,
+       [](DotType& dot, FloatType angle) { dot.LotateAroundZAxisSelf(angle); }},
+  };
+  for (const auto& rotation : rotations) {
+    size_t mismatches = 0;
+    for (const size_t count : kCounts) {
+      for (const double angle : kAngles) {
+        std::vector<DotType> actual = MakeRandomDots(rng, count);
+        std::vector<DotType> expected = actual;
+        rotation.kernel(actual.data(), count, FloatType(angle));
+        for (auto& dot : expected) {
+          rotation.reference(dot, FloatType(angle));
+        }
+        mismatches += CountMismatches(actual, expected);
+      }
+    }
+    passed &= Report(isa_name + " rotate " + rotation.name, mismatches);
+  }
+
+  size_t mismatches = 0;
+  for (const size_t count : kCounts) {
+    const std::vector<DotType> in = MakeRandomDots(rng, count);
+    const std::vector<DotType> parameters = MakeRandomDots(rng, 2);
+    std::vector<DotType> actual(count);
+    DotKernels::Project(in.data(), actual.data(), count, parameters[0],
+                        parameters[1]);
+    std::vector<DotType> expected;
+    expected.reserve(count);
+    for (const auto& dot : in) {
+      expected.push_back(dot.ElementWiseMultiplication(parameters[0]) +
+                         parameters[1]);
+    }
+    mismatches += CountMismatches(actual, expected);
+  }
+  passed &= Report(isa_name + " project", mismatches);
+  return passed;
+}
+
+}  // namespace
+
+int main(void) {
+  struct Path {
+    DotKernels::Isa isa;
+    const char* name;
+  };
+  const Path paths[] = {
+      {DotKernels::Isa::kScalar, "scalar"},
+      {DotKernels::Isa::kAvx2, "avx2"},
+  };
+  bool passed = true;
+  for (const auto& path : paths) {
+    DotKernels::SetIsa(path.isa);
+    if (DotKernels::GetIsa() != path.isa) {
+      std::cout << "SKIP " << path.name << " (not supported by this CPU)"
+                << std::endl;
+      continue;
+    }
+    passed &= CheckKernels(path.name);
+  }
+  // The startup check must agree with the exhaustive one above.
+  DotKernels::SetIsa(DotKernels::Isa::kAvx2);
+  const bool enabled = DotKernels::Enable();
+  std::cout << (enabled == passed ? "PASS " : "FAIL ") << "enable check"
+            << std::endl;
+  passed &= enabled == passed;
+  return passed ? 0 : 1;
+}
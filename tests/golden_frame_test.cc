@@ -0,0 +1,241 @@
+// Renders fixed scenes headlessly and compares them with the frames stored
+// in tests/golden, to catch silent changes in rasterizer output.
+//
+//   golden_frame_test [--update] [dir]
+//
+// --update rewrites the stored frames after an intended output change; see
+// `make golden`.
+
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <string>
+#include <utility>
+
+#include "animation_track.h"
+#include "console_coordinate.h"
+#include "golden_frame.h"
+#include "mesh_generator.hpp"
+#include "sample_scenes.h"
+
+using namespace lotate_polyhedron;
+
+namespace {
+
+using MeshGeneratorType = MeshGenerator<ConsoleCoordinate::FloatType>;
+
+// Renders every case, and either stores the frames in dir or compares them
+// with the ones stored there.
+int RunGoldenFrames(const std::string& dir, bool update) {
+  struct GoldenCase {
+    const char* name;
+    void (*add_shape)(ConsoleCoordinate&);
+    double x, y, z;
+    size_t width, height;
+    double zoom;
+    ConsoleBuffer::ShadingMode shading_mode;
+    bool three_views;
+    bool binned;
+  };
+  using ShadingMode = ConsoleBuffer::ShadingMode;
+  const GoldenCase cases[] = {
+      // Axis aligned cube exercises the vertical-line branch.
+      {"cube_front", AddCubeToCoordinate, 0.0, 0.0, 0.0, 80, 24, 6,
+       ShadingMode::kNone, false, false},
+      {"cube_tilted", AddCubeToCoordinate, 0.3, 0.5, 0.1, 80, 24, 6,
+       ShadingMode::kNone, false, false},
+      {"cube_turned", AddCubeToCoordinate, 1.0, 0.2, 0.7, 80, 24, 6,
+       ShadingMode::kNone, false, false},
+      // Larger than the frame, so every boundary check is hit.
+      {"cube_clipped", AddCubeToCoordinate, 0.3, 0.5, 0.1, 40, 12, 8,
+       ShadingMode::kNone, false, false},
+      {"pyramid_front", AddPyramidToCoordinate, 0.0, 0.0, 0.0, 80, 24, 6,
+       ShadingMode::kNone, false, false},
+      {"pyramid_tilted", AddPyramidToCoordinate, 0.3, 0.5, 0.1, 80, 24, 6,
+       ShadingMode::kNone, false, false},
+      {"cube_tilted_aa", AddCubeToCoordinate, 0.3, 0.5, 0.1, 80, 24, 6,
+       ShadingMode::kGlyphRamp, false, false},
+      {"pyramid_tilted_aa", AddPyramidToCoordinate, 0.3, 0.5, 0.1, 80, 24, 6,
+       ShadingMode::kGlyphRamp, false, false},
+      // Far edges fade towards the dimmest glyphs.
+      {"cube_tilted_depth",
+       [](ConsoleCoordinate& cc) {
+         AddCubeToCoordinate(cc);
+         cc.SetDepthShading(true);
+       },
+       0.3, 0.5, 0.1, 80, 24, 6, ShadingMode::kGlyphRamp, false, false},
+      {"cube_tilted_views", AddCubeToCoordinate, 0.3, 0.5, 0.1, 120, 24, 4,
+       ShadingMode::kNone, true, false},
+      {"pyramid_tilted_views", AddPyramidToCoordinate, 0.3, 0.5, 0.1, 120,
+       24, 4, ShadingMode::kNone, true, false},
+      {"sphere_tilted",
+       [](ConsoleCoordinate& cc) {
+         cc.AddShpae(MeshGeneratorType::GenerateUvSphere(6, 12));
+       },
+       0.3, 0.5, 0.1, 80, 24, 10, ShadingMode::kNone, false, false},
+      {"torus_tilted",
+       [](ConsoleCoordinate& cc) {
+         cc.AddShpae(MeshGeneratorType::GenerateTorus(16, 6));
+       },
+       0.3, 0.5, 0.1, 80, 24, 10, ShadingMode::kNone, false, false},
+      {"icosphere_tilted",
+       [](ConsoleCoordinate& cc) {
+         cc.AddShpae(MeshGeneratorType::GenerateIcosphere(1));
+       },
+       0.3, 0.5, 0.1, 80, 24, 10, ShadingMode::kNone, false, false},
+      // Zoomed out far enough for a coarser level of detail to be picked.
+      {"sphere_lod",
+       [](ConsoleCoordinate& cc) {
+         auto sphere = MeshGeneratorType::GenerateUvSphere(24, 48);
+         sphere.BuildLevelsOfDetail();
+         cc.AddShpae(std::move(sphere));
+       },
+       0.3, 0.5, 0.1, 80, 24, 2, ShadingMode::kNone, false, false},
+      // Posed at four times its size, so it needs a finer level than its
+      // zoom alone calls for.
+      {"sphere_lod_scaled",
+       [](ConsoleCoordinate& cc) {
+         auto sphere = MeshGeneratorType::GenerateUvSphere(24, 48);
+         sphere.BuildLevelsOfDetail();
+         cc.AddShpae(std::move(sphere));
+         AnimationTrack track;
+         track.AddScaleKey(0.0, {4.0, 4.0, 4.0});
+         cc.SetAnimationTrack(0, track);
+       },
+       0.3, 0.5, 0.1, 80, 24, 0.7, ShadingMode::kNone, false, false},
+      {"torus_silhouette",
+       [](ConsoleCoordinate& cc) {
+         cc.AddShpae(MeshGeneratorType::GenerateTorus(32, 12));
+         cc.SetSilhouetteOnly(true);
+       },
+       0.6, 0.5, 0.1, 80, 24, 10, ShadingMode::kNone, false, false},
+      // Keys straddle the animation time, so every channel interpolates.
+      {"cube_animated",
+       [](ConsoleCoordinate& cc) {
+         AddCubeToCoordinate(cc);
+         AddTurntableTracks(cc);
+         cc.SetAnimationTime(1.3);
+       },
+       0.0, 0.0, 0.0, 80, 24, 6, ShadingMode::kNone, false, false},
+      {"cube_tilted_binned", AddCubeToCoordinate, 0.3, 0.5, 0.1, 80, 24, 6,
+       ShadingMode::kNone, false, true},
+      {"cube_clipped_binned", AddCubeToCoordinate, 0.3, 0.5, 0.1, 40, 12, 8,
+       ShadingMode::kNone, false, true},
+      {"pyramid_tilted_views_binned", AddPyramidToCoordinate, 0.3, 0.5, 0.1,
+       120, 24, 4, ShadingMode::kNone, true, true},
+      // Static shapes; also checked against the dynamic cases below.
+      {"cube_tilted_static", AddStaticCubeToCoordinate, 0.3, 0.5, 0.1, 80, 24,
+       6, ShadingMode::kNone, false, false},
+      {"pyramid_tilted_aa_static", AddStaticPyramidToCoordinate, 0.3, 0.5,
+       0.1, 80, 24, 6, ShadingMode::kGlyphRamp, false, false},
+      {"pyramid_tilted_views_binned_static", AddStaticPyramidToCoordinate,
+       0.3, 0.5, 0.1, 120, 24, 4, ShadingMode::kNone, true, true},
+      // A gizmo drawn over a dynamic shape.
+      {"cube_tilted_axes",
+       [](ConsoleCoordinate& cc) {
+         AddCubeToCoordinate(cc);
+         AddStaticAxesToCoordinate(cc);
+       },
+       0.3, 0.5, 0.1, 80, 24, 6, ShadingMode::kNone, false, false},
+  };
+
+  // Frames of the same scene drawn two ways. Static shapes must draw
+  // exactly like their dynamic counterparts. Different rasterizers are not
+  // expected to match cell for cell, so only ink placement is compared:
+  // every cell the stepping rasterizer inks must be inked nearby by the
+  // binned one, which also fills the gaps stepping leaves on steep edges.
+  struct CrossCheck {
+    const char* name;
+    const char* reference;
+    GoldenFrame::ToleranceMode mode;
+  };
+  using ToleranceMode = GoldenFrame::ToleranceMode;
+  const CrossCheck cross_checks[] = {
+      {"cube_tilted_static", "cube_tilted", ToleranceMode::kExact},
+      {"pyramid_tilted_aa_static", "pyramid_tilted_aa",
+       ToleranceMode::kExact},
+      {"pyramid_tilted_views_binned_static", "pyramid_tilted_views_binned",
+       ToleranceMode::kExact},
+      {"cube_tilted_binned", "cube_tilted", ToleranceMode::kNeighborhood},
+      {"cube_clipped_binned", "cube_clipped", ToleranceMode::kNeighborhood},
+      {"pyramid_tilted_views_binned", "pyramid_tilted_views",
+       ToleranceMode::kNeighborhood},
+  };
+
+  int failures = 0;
+  const auto report = [&failures](const std::string& name,
+                                  const GoldenFrame::CompareResult& result) {
+    std::cout << (result.passed ? "PASS " : "FAIL ") << name;
+    if (!result.passed) {
+      std::cout << " (" << result.mismatches << " cells differ"
+                << (result.size_matched ? "" : ", size differs") << ")";
+      ++failures;
+    }
+    std::cout << std::endl;
+  };
+  std::map<std::string, GoldenFrame> frames;
+  for (const auto& golden_case : cases) {
+    ConsoleCoordinate cc(golden_case.width, golden_case.height,
+                         golden_case.zoom);
+    golden_case.add_shape(cc);
+    cc.LotateEveryShapeAroundXAxis(ConsoleCoordinate::FloatType(golden_case.x));
+    cc.LotateEveryShapeAroundYAxis(ConsoleCoordinate::FloatType(golden_case.y));
+    cc.LotateEveryShapeAroundZAxis(ConsoleCoordinate::FloatType(golden_case.z));
+    cc.SetShadingMode(golden_case.shading_mode);
+    if (golden_case.three_views) {
+      SetThreeViews(cc, golden_case.zoom);
+    }
+    cc.SetBinnedRasterization(golden_case.binned);
+    cc.Clear();
+    cc.Rasterize();
+
+    const GoldenFrame& actual =
+        frames.emplace(golden_case.name, GoldenFrame(cc)).first->second;
+    const std::string path = dir + "/" + golden_case.name + ".txt";
+    if (update) {
+      if (!actual.Save(path)) {
+        std::cerr << "cannot write " << path << std::endl;
+        ++failures;
+      }
+      continue;
+    }
+
+    GoldenFrame expected;
+    if (!expected.Load(path)) {
+      std::cerr << "cannot read " << path << std::endl;
+      ++failures;
+      continue;
+    }
+    // Rendering is deterministic, so every frame must match its own golden
+    // exactly.
+    report(golden_case.name,
+           expected.Compare(actual, GoldenFrame::Tolerance()));
+  }
+
+  if (!update) {
+    for (const auto& check : cross_checks) {
+      GoldenFrame::Tolerance tolerance;
+      tolerance.mode = check.mode;
+      tolerance.symmetric = false;
+      report(std::string(check.name) + " ~ " + check.reference,
+             frames.at(check.reference)
+                 .Compare(frames.at(check.name), tolerance));
+    }
+  }
+  return failures == 0 ? 0 : 1;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  bool update = false;
+  std::string dir = "tests/golden";
+  for (int i = 1; i < argc; ++i) {
+    if (strcmp(argv[i], "--update") == 0) {
+      update = true;
+    } else {
+      dir = argv[i];
+    }
+  }
+  return RunGoldenFrames(dir, update);
+}
@@ -0,0 +1,165 @@
+// Checks that drawing a frame does not touch the heap once the scene has
+// warmed up. Global operator new is replaced to count every allocation, on
+// any thread, made while a scenario draws its steady-state frames.
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <new>
+#include <utility>
+
+#include "animation_track.h"
+#include "console_buffer.h"
+#include "console_coordinate.h"
+#include "mesh_generator.hpp"
+#include "output_backend.h"
+#include "sample_scenes.h"
+#include "stats.h"
+
+namespace {
+
+std::atomic<bool> g_counting(false);
+std::atomic<uint64_t> g_allocations(0);
+
+void* Allocate(size_t size) {
+  if (g_counting.load(std::memory_order_relaxed)) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+  }
+  void* p = std::malloc(size == 0 ? 1 : size);
+  if (p == nullptr) {
+    throw std::bad_alloc();
+  }
+  return p;
+}
+
+}  // namespace
+
+// The array and nothrow forms default to these two.
+void* operator new(size_t size) { return Allocate(size); }
+
+void operator delete(void* p) noexcept { std::free(p); }
+
+void operator delete(void* p, size_t size) noexcept {
+  (void)size;
+  std::free(p);
+}
+
+using namespace lotate_polyhedron;
+
+namespace {
+
+using FloatType = ConsoleCoordinate::FloatType;
+using MeshGeneratorType = MeshGenerator<FloatType>;
+
+constexpr size_t kWarmUpFrames = 8;
+constexpr size_t kFrames = 64;
+
+struct Scenario {
+  const char* name;
+  std::function<void(ConsoleCoordinate&)> set_up;
+  bool animated;
+};
+
+// Draws frames the way the interactive loop does and returns the number of
+// allocations made during the last kFrames of them.
+uint64_t CountSteadyStateAllocations(const Scenario& scenario) {
+  ConsoleCoordinate cc(120, 40, 8);
+  scenario.set_up(cc);
+  const FloatType angle(0.03);
+  for (size_t frame = 0; frame < kWarmUpFrames + kFrames; ++frame) {
+    if (frame == kWarmUpFrames) {
+      g_allocations.store(0);
+      g_counting.store(true);
+    }
+    cc.Clear();
+    cc.Draw();
+    if (scenario.animated) {
+      cc.SetAnimationTime(0.1 * frame);
+    } else {
+      cc.LotateEveryShapeAroundXAxis(angle);
+      cc.LotateEveryShapeAroundYAxis(angle);
+      cc.LotateEveryShapeAroundZAxis(angle);
+    }
+    Stats::EndFrame();
+  }
+  g_counting.store(false);
+  return g_allocations.load();
+}
+
+}  // namespace
+
+int main(void) {
+  NullOutput output;
+  ConsoleBuffer::SetOutputBackend(&output);
+
+  const Scenario scenarios[] = {
+      {"stepping",
+       [](ConsoleCoordinate& cc) {
+         cc.AddShpae(MeshGeneratorType::GenerateTorus(16, 6));
+       },
+       false},
+      {"anti-aliased",
+       [](ConsoleCoordinate& cc) {
+         cc.AddShpae(MeshGeneratorType::GenerateIcosphere(1));
+         cc.SetShadingMode(ConsoleBuffer::ShadingMode::kGlyphRamp);
+       },
+       false},
+      {"binned views",
+       [](ConsoleCoordinate& cc) {
+         cc.AddShpae(MeshGeneratorType::GenerateUvSphere(6, 12));
+         cc.SetBinnedRasterization(true);
+         SetThreeViews(cc, 4);
+       },
+       false},
+      {"silhouette",
+       [](ConsoleCoordinate& cc) {
+         cc.AddShpae(MeshGeneratorType::GenerateTorus(32, 12));
+         cc.SetSilhouetteOnly(true);
+       },
+       false},
+      {"animated lod",
+       [](ConsoleCoordinate& cc) {
+         auto sphere = MeshGeneratorType::GenerateUvSphere(24, 48);
+         sphere.BuildLevelsOfDetail();
+         cc.AddShpae(std::move(sphere));
+         AnimationTrack track;
+         track.AddRotationKey(
+             0.0, AnimationTrack::Quaternion::FromEulerAngles(0, 0, 0));
+         track.AddRotationKey(
+             10.0, AnimationTrack::Quaternion::FromEulerAngles(0.4, 3, 0));
+         track.AddScaleKey(0.0, {0.2, 0.2, 0.2});
+         track.AddScaleKey(10.0, {3.0, 3.0, 3.0});
+         cc.SetAnimationTrack(0, track);
+       },
+       true},
+      {"pick probe",
+       [](ConsoleCoordinate& cc) {
+         cc.AddShpae(MeshGeneratorType::GenerateIcosphere(1));
+         cc.SetPickProbe(60, 20);
+       },
+       false},
+      {"stats overlay",
+       [](ConsoleCoordinate& cc) {
+         cc.AddShpae(MeshGeneratorType::GenerateIcosphere(1));
+         cc.SetStatsOverlay(true);
+       },
+       false},
+  };
+
+  bool passed = true;
+  for (const auto& scenario : scenarios) {
+    const uint64_t allocations = CountSteadyStateAllocations(scenario);
+    std::cout << (allocations == 0 ? "PASS " : "FAIL ") << scenario.name;
+    if (allocations != 0) {
+      std::cout << " (" << allocations << " allocations in " << kFrames
+                << " frames)";
+      passed = false;
+    }
+    std::cout << std::endl;
+  }
+  ConsoleBuffer::SetOutputBackend(nullptr);
+  return passed ? 0 : 1;
+}